@@ -31,6 +31,156 @@
 
 #include "salibc.h"
 
+#if defined (__x86_64__) || defined (__i386__) || DOXYGEN
+
+/**
+ * @brief Defined if the numeric kernels can select SSE2 and AVX2 code at
+ * runtime.
+ */
+#define SALIBC_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Empty slot of a hash index.
+ */
+#define HASHINDEX_EMPTY (-1)
+
+/**
+ * @brief Slot of a hash index whose value has been removed.
+ */
+#define HASHINDEX_TOMBSTONE (-2)
+
+/**
+ * @brief Minimum number of slots of a hash index.
+ */
+#define HASHINDEX_MINSLOTS 16
+
+/**
+ * @brief Maximum number of slots of a hash index, the largest power of two
+ * that fits an int.
+ */
+#define HASHINDEX_MAXSLOTS (1 << 30)
+
+/**
+ * @brief Best instruction set that the numeric kernels may use.
+ */
+static Arraysimd array_simdlimit = ARRAY_AVX2;
+
+/**
+ * @brief Buffer retired by the concurrent read mode.
+ */
+struct Arrayretired
+{
+  /**
+   * @brief The buffer.
+   */
+  char *ptr;
+  /**
+   * @brief The epoch when the buffer was retired.
+   */
+  uint64_t epoch;
+};
+
+/**
+ * @brief Storage for one element of any Arraytype.
+ *
+ * The minimum and maximum kernels access it through a pointer to the
+ * member of the right type.
+ */
+union Arrayvalue
+{
+  /**
+   * @brief ARRAY_INT32 element.
+   */
+  int32_t i32;
+  /**
+   * @brief ARRAY_INT64 element.
+   */
+  int64_t i64;
+  /**
+   * @brief ARRAY_FLOAT element.
+   */
+  float f;
+  /**
+   * @brief ARRAY_DOUBLE element.
+   */
+  double d;
+};
+
+/**
+ * @brief Current element of an array of a k-way merge.
+ */
+struct Arraymergehead
+{
+  /**
+   * @brief The index of the element.
+   */
+  int pos;
+  /**
+   * @brief The memory address of the element.
+   */
+  char *ptr;
+  /**
+   * @brief The element as an unsigned integer, if it is compared as one.
+   */
+  uint64_t key;
+};
+
+/**
+ * @brief Mask of the number of reserved slots in the counts of a concurrent
+ * append array.
+ */
+#define CONCARRAY_SLOTS UINT64_C (0xffffffff)
+
+/**
+ * @brief Number of elements ahead of the current one whose indexed address
+ * is prefetched by the gather and scatter loops.
+ */
+#define ARRAY_PREFETCH 16
+
+/**
+ * @brief Length ratio above which array_intersect gallops through the
+ * longer array instead of using the SSE2 block loop.
+ */
+#define ARRAY_SKEW 32
+
+/**
+ * @brief Bulk operations of bitarray_combine.
+ */
+#define BITARRAY_AND 0
+#define BITARRAY_OR 1
+#define BITARRAY_XOR 2
+#define BITARRAY_ANDNOT 3
+
+/**
+ * @brief Length of the runs sorted by insertion before being merged by
+ * array_argsort.
+ */
+#define ARRAY_ARGSORT_RUN 16
+
+/**
+ * @brief Maximum number of differences of a compressed integer array block
+ * that are stored as exceptions.
+ */
+#define CINTARRAY_EXCEPTIONS 16
+
+/**
+ * @brief Slot of a hash index.
+ */
+struct Hashslot
+{
+  /**
+   * @brief Hash value of the element.
+   */
+  uint32_t hash;
+  /**
+   * @brief Last index linked with this value, HASHINDEX_EMPTY or
+   * HASHINDEX_TOMBSTONE.
+   */
+  int head;
+};
+
 /**
  * @brief Check if the input memory address points to NULL.
  *
@@ -81,420 +231,5009 @@ static bool array_indexoutofbounds (Array a, int index);
  */
 static bool array_memcopy (Array a, int index, void *element);
 
-/*
- ***************************
- *General purpose methods. *
- ***************************
+/**
+ * @brief Mark the beginning of a change made by the writer.
+ *
+ * @param[in] a The pointer to an array ADT instance.
  */
-static bool
-element_null (void *element)
-{
-  return (element == NULL);
-}
+static void array_writebegin (Array a);
 
-#if defined (MEMORY_OVERLAP_CHECK) || DOXYGEN
+/**
+ * @brief Mark the end of a change made by the writer.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ */
+static void array_writeend (Array a);
 
 /**
- * @brief If this flag is defined memory_overlaps function will work normally,
- * otherwise it will only return false. By default this flag is deactivated.
+ * @brief Wait until no change is in progress and get the sequence counter.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ *
+ * @retval seq The sequence counter at the beginning of the read.
  */
-#define MEMORY_OVERLAP_CHECK
+static unsigned int array_readbegin (Array a);
 
 /**
- * @note Since memory is not always allocated consecutively, the following
- * controls may fail because only memory addresses are checked and the
- * system does not know if the memory in between belongs to something else.
+ * @brief Check if a read must be retried.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] seq The value returned by array_readbegin.
+ *
+ * @retval true The array changed during the read.
+ * @retval false The read is consistent.
  */
-static bool
-memory_overlaps (void *chunk1, void *chunk2, size_t fullsize)
-{
-  char *c1 = chunk1, *c2 = chunk2;
+static bool array_readretry (Array a, unsigned int seq);
 
-  if (element_null (chunk1) || element_null (chunk2))
-    return false;
+/**
+ * @brief Register a reader of an array in the current epoch.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ *
+ * @retval parity The counter where the reader is registered, to be passed
+ * to array_readexit.
+ */
+static int array_readenter (Array a);
 
-  /* |-----------|
-   * |     |-----|-------|
-   * c1   c2  c1+fullsize  c2+smt
-   * c2   c1  c2+fullsize  c1+smt
-   *
-   */
-  return ((c1 <= c2) && (c1 + fullsize >= c2)) || ((c2 <= c1)
-						   && (c2 + fullsize >= c1));
-}
-#else
-static bool
-memory_overlaps (void *chunk1, void *chunk2, size_t fullsize)
-{
-  (void) chunk1;
-  (void) chunk2;
-  (void) fullsize;
-  return false;
-}
-#endif
+/**
+ * @brief Unregister a reader of an array.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] parity The value returned by array_readenter.
+ */
+static void array_readexit (Array a, int parity);
 
-/*
- ******************
- * Mixed methods. *
- ******************
+/**
+ * @brief Free the buffers retired before an epoch.
+ *
+ * @param[in] a The pointer to an array ADT instance in concurrent read mode.
+ * @param[in] bound The first epoch whose buffers are kept.
  */
+static void array_freeretired (Array a, uint64_t bound);
 
 /**
- * @note The non-ADT part of the array is deleted (as well as some fields of
- * the ADT).
+ * @brief Resize an array in concurrent read mode.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] new_length The new length of the array.
+ *
+ * @retval true Array resize successful.
+ * @retval false Array resize unsuccessful.
+ *
+ * The old buffer is retired instead of being freed.
  */
-static void
-realarray_delete (Array a)
-{
-  if (array_null (a))
-    return;
+static bool array_concurrentresize (Array a, int new_length);
 
-  free (array_pointer (a));
-  a->ptr = NULL;
-  a->nmemb = 0;
-}
+/**
+ * @brief Make room for a number of elements without changing the length.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] capacity The number of elements the buffer must fit.
+ *
+ * @retval true The buffer fits capacity elements.
+ * @retval false Memory allocation error. The array is left unchanged.
+ *
+ * In concurrent read mode, a replaced buffer is retired.
+ */
+static bool array_reserve (Array a, int capacity);
 
-/*
- ***************************
- * Array specific methods. *
- ***************************
+/**
+ * @brief Give back the memory past the length of an array.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ *
+ * The length must already have been lowered, so the array is left intact
+ * when the buffer cannot be shrunk.
  */
-static bool
-array_indexoutofbounds (Array a, int index)
-{
-  return ((index < 0) || (index > array_length (a) - 1));
-}
+static void array_shrinktofit (Array a);
 
-static char *
-array_indexpointer (Array a, int index)
-{
-  if (array_null (a))
-    return NULL;
+/**
+ * @brief Lower the length of an array.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] new_length The new length, not greater than the current one.
+ *
+ * Unlike array_resize, this cannot fail: the elements past new_length are
+ * dropped first and the buffer is shrunk afterwards, if possible.
+ */
+static void array_truncate (Array a, int new_length);
 
-  /* Array bound check. */
-  if (array_indexoutofbounds (a, index))
-    return NULL;
+/**
+ * @brief Resize an array to a new specified length, ignoring its index.
+ */
+static bool array_realresize (Array a, int new_length);
 
-  return (array_pointer (a) + (((size_t) index) * array_size (a)));
-}
+/**
+ * @brief Detach the hash index of an array before its elements are moved.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ *
+ * @retval hi The detached hash index, or NULL.
+ */
+static Hashindex array_suspendindex (Array a);
 
 /**
- * @note It is assumed that element has the same size of a->ptr.
+ * @brief Attach again a hash index detached by array_suspendindex and
+ * rebuild it.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] hi The hash index.
  */
-static bool
-array_memcopy (Array a, int index, void *element)
-{
-  if (array_null (a))
-    return false;
+static void array_resumeindex (Array a, Hashindex hi);
 
-  /**
-   * @note Even though the array_indexoutofbounds function is called inside the
-   * array_indexpointer function, this returns NULL, so memcpy would be done
-   * on a dest of NULL. That's why we need to call that function here as well
-   */
-   /** @code */
-  if (!element_null (element)
-      && !memory_overlaps (a, element, array_fullsize (a))
-      && !array_indexoutofbounds (a, index))
-    {
-      memcpy (array_indexpointer (a, index), element, array_size (a));
-      return true;
-    }
-  /** @endcode */
-  else
-    return false;
-}
+/**
+ * @brief Compare two elements.
+ *
+ * @param[in] size The size of the elements.
+ * @param[in] cmp A qsort-like comparison function, or NULL.
+ * @param[in] e1 The memory address of the first element.
+ * @param[in] e2 The memory address of the second element.
+ *
+ * @retval cmp(e1,e2) If cmp is not NULL.
+ *
+ * If cmp is NULL, 4 and 8 byte elements are compared as unsigned integers
+ * and the other ones with memcmp.
+ */
+static int array_compare (size_t size,
+			  int (*cmp) (const void *, const void *),
+			  const void *e1, const void *e2);
 
-bool
-array_null (Array a)
-{
-  return (element_null (a));
-}
+/**
+ * @brief Find where an element would be placed in a sorted array, with an
+ * exponential search followed by a binary search.
+ *
+ * @param[in] a The pointer to a sorted array ADT instance.
+ * @param[in] from The index where to start searching.
+ * @param[in] element The memory address of the element.
+ * @param[in] cmp A qsort-like comparison function, or NULL.
+ * @param[in] upper false to get the first index whose element is not less
+ * than element, true to get the first index whose element is greater than
+ * element.
+ *
+ * @retval index An index between from and the length of the array.
+ *
+ * The cost is logarithmic in the distance from the starting index, so long
+ * runs of a much larger array are skipped quickly.
+ */
+static int array_gallop (Array a, int from, void *element,
+			 int (*cmp) (const void *, const void *), bool upper);
 
-bool
-array_empty (Array a)
-{
-  assert (!array_null (a));
-  return (array_length (a) == 0);
-}
+/**
+ * @brief Copy consecutive elements at the end of an output array whose
+ * length is used as a cursor.
+ *
+ * @param[in] out The pointer to the output array ADT instance.
+ * @param[in] count The memory address of the number of elements already
+ * stored in out.
+ * @param[in] a The pointer to the input array ADT instance.
+ * @param[in] from The first index to be copied.
+ * @param[in] to The index after the last one to be copied.
+ */
+static void array_copyrange (Array out, int *count, Array a, int from,
+			     int to);
 
-size_t
-array_size (Array a)
-{
-  assert (!array_null (a));
-  return (a->size);
+/**
+ * @brief Create the output array of a set operation.
+ *
+ * @param[in] a1 The pointer the first array ADT instance.
+ * @param[in] a2 The pointer the second array ADT instance.
+ * @param[in] nmemb The maximum number of elements of the output.
+ *
+ * @retval a3 The pointer to the new array ADT istance.
+ *
+ * @warning This function may return NULL if some problem occured or if the
+ * inputs cannot be combined.
+ */
+static Array array_setnew (Array a1, Array a2, long nmemb);
+
+/**
+ * @brief Shrink the output array of a set operation.
+ *
+ * @param[in] a The pointer to the output array ADT instance.
+ * @param[in] count The number of elements stored.
+ *
+ * @retval a The pointer to the array ADT istance.
+ */
+static Array array_setend (Array a, int count);
+
+#if defined (SALIBC_X86) || DOXYGEN
+
+/**
+ * @brief Intersect two sorted sets of 32 bit unsigned integers, four
+ * elements at a time.
+ *
+ * @param[in] a1 The pointer the first array ADT instance.
+ * @param[in] a2 The pointer the second array ADT instance.
+ * @param[in,out] i The memory address of the current index of a1.
+ * @param[in,out] j The memory address of the current index of a2.
+ * @param[in] a3 The pointer to the output array ADT instance.
+ * @param[in,out] count The memory address of the number of elements
+ * already stored in a3.
+ *
+ * This stops when one of the arrays has less than four elements left, so
+ * the caller must finish the job.
+ */
+static void array_intersectsse (Array a1, Array a2, int *i, int *j, Array a3,
+				int *count) __attribute__ ((target ("sse2")));
+#endif
+
+/**
+ * @brief Move the head of an array of a k-way merge.
+ *
+ * @param[in] a The pointer to the array ADT instance.
+ * @param[out] head The memory address of the head of the array.
+ * @param[in] pos The new index of the head.
+ * @param[in] cmp A qsort-like comparison function, or NULL.
+ *
+ * Without a comparison function, 4 and 8 byte elements are loaded as
+ * unsigned integers, so that array_heapbefore compares them directly.
+ */
+static void array_mergeload (Array a, struct Arraymergehead *head, int pos,
+			     int (*cmp) (const void *, const void *));
+
+/**
+ * @brief Check if the head of an array of a k-way merge must be output
+ * before the one of another array.
+ *
+ * @param[in] heads The heads of the arrays.
+ * @param[in] size The size of the elements.
+ * @param[in] cmp A qsort-like comparison function, or NULL.
+ * @param[in] x The first array number.
+ * @param[in] y The second array number.
+ *
+ * @retval true The element of x comes first.
+ * @retval false The element of y comes first.
+ */
+static bool array_heapbefore (struct Arraymergehead *heads, size_t size,
+			      int (*cmp) (const void *, const void *), int x,
+			      int y);
+
+/**
+ * @brief Restore the heap property of a k-way merge heap.
+ *
+ * @param[in] heads The heads of the arrays.
+ * @param[in] heap The heap of array numbers.
+ * @param[in] n The number of arrays in the heap.
+ * @param[in] root The position of the heap where to start.
+ * @param[in] size The size of the elements.
+ * @param[in] cmp A qsort-like comparison function, or NULL.
+ */
+static void array_siftdown (struct Arraymergehead *heads, int *heap, int n,
+			    int root, size_t size,
+			    int (*cmp) (const void *, const void *));
+
+/**
+ * @brief Hash an element.
+ *
+ * @param[in] element The memory address of the element.
+ * @param[in] size The size of the element.
+ *
+ * @retval hash The hash value.
+ *
+ * Elements of 4, 8 and 16 bytes have their own specialized mixers.
+ */
+static uint32_t hashindex_hash (void *element, size_t size);
+
+/**
+ * @brief Get the slots of a hash index.
+ *
+ * @param[in] hi The pointer to a hash index ADT instance.
+ *
+ * @retval slots The memory address of the first slot.
+ */
+static struct Hashslot *hashindex_slots (Hashindex hi);
+
+/**
+ * @brief Find the slot of an element value.
+ *
+ * @param[in] a The pointer to an array ADT instance with a hash index.
+ * @param[in] element The memory address of the element.
+ * @param[in] hash The hash value of the element.
+ *
+ * @retval slot The slot number.
+ * @retval -1 The element value is not in the index.
+ */
+static int hashindex_lookup (Array a, void *element, uint32_t hash);
+
+/**
+ * @brief Move the slots of a hash index to a table of a new size.
+ *
+ * @param[in] hi The pointer to a hash index ADT instance.
+ * @param[in] capacity The new number of slots, a power of two.
+ *
+ * @retval true Rehash successful.
+ * @retval false Rehash unsuccessful. The index is left unchanged.
+ */
+static bool hashindex_rehash (Hashindex hi, int capacity);
+
+/**
+ * @brief Add an index of the array to the hash index.
+ *
+ * @param[in] a The pointer to an array ADT instance with a hash index.
+ * @param[in] index The index to be added.
+ *
+ * @retval true Link successful.
+ * @retval false Link unsuccessful.
+ */
+static bool hashindex_link (Array a, int index);
+
+/**
+ * @brief Remove an index of the array from the hash index.
+ *
+ * @param[in] a The pointer to an array ADT instance with a hash index.
+ * @param[in] index The index to be removed.
+ */
+static void hashindex_unlink (Array a, int index);
+
+/**
+ * @brief Build the hash index from scratch.
+ *
+ * @param[in] a The pointer to an array ADT instance with a hash index.
+ *
+ * @retval true Build successful.
+ * @retval false Build unsuccessful.
+ */
+static bool hashindex_build (Array a);
+
+/**
+ * @brief Check that an array holds valid indices.
+ *
+ * @param[in] idx The pointer to an array ADT instance.
+ * @param[in] bound The number of valid indices.
+ *
+ * @retval true idx is an array of int whose elements are between 0 and
+ * bound - 1.
+ * @retval false Some element of idx is not a valid index.
+ */
+static bool array_checkindices (Array idx, int bound);
+
+/**
+ * @brief Copy one element.
+ *
+ * @param[out] to The memory address of the destination.
+ * @param[in] from The memory address of the source.
+ * @param[in] size The size of the element.
+ *
+ * 4 and 8 byte elements are copied with constant size copies, which the
+ * compiler turns into single moves.
+ */
+static void array_moveelement (char *to, const char *from, size_t size);
+
+/**
+ * @brief Prefetch an element for reading or for writing.
+ *
+ * @param[in] element The memory address of the element.
+ * @param[in] write true if the element is going to be written.
+ *
+ * The access type of __builtin_prefetch must be a constant, so each one
+ * gets its own call.
+ */
+static void array_prefetch (const char *element, bool write);
+
+/**
+ * @brief Gather or scatter the elements of a buffer.
+ *
+ * @param[out] out The memory address of the destination buffer.
+ * @param[in] in The memory address of the source buffer.
+ * @param[in] idx The indices.
+ * @param[in] n The number of indices.
+ * @param[in] size The size of the elements.
+ * @param[in] scatter false to copy in[idx[i]] to out[i], true to copy in[i]
+ * to out[idx[i]].
+ */
+static void array_reorder (char *out, const char *in, const int *idx, int n,
+			   size_t size, bool scatter);
+
+/**
+ * @brief Mark every index of a permutation, without moving elements.
+ *
+ * @param[in,out] perm The permutation, whose elements are replaced by their
+ * one's complement.
+ * @param[in] n The length of perm.
+ *
+ * @retval true perm is a permutation.
+ * @retval false perm is not a permutation; it is restored.
+ */
+static bool array_markindices (int *perm, int n);
+
+/**
+ * @brief Merge two adjacent sorted runs of indices.
+ *
+ * @param[in] a The pointer to the array ADT instance that is sorted.
+ * @param[in] cmp A qsort-like comparison function, or NULL.
+ * @param[in] in The runs.
+ * @param[out] out The merged run.
+ * @param[in] from The start of the first run.
+ * @param[in] mid The start of the second run.
+ * @param[in] to The end of the second run.
+ */
+static void array_argmerge (Array a, int (*cmp) (const void *, const void *),
+			    const int *in, int *out, int from, int mid,
+			    int to);
+
+/**
+ * @brief Check if an array can be used with a numeric type.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] type The type of the elements.
+ *
+ * @retval true The size of the elements matches type.
+ * @retval false The array is NULL or its elements have another size.
+ */
+static bool array_typecheck (Array a, Arraytype type);
+
+/**
+ * @brief Scalar sum kernel.
+ *
+ * @param[in] type The type of the elements.
+ * @param[in] p The memory address of the first element.
+ * @param[in] n The number of elements.
+ * @param[in,out] sum The memory address of the partial sum, as in
+ * array_sum, to which the elements are added.
+ */
+static void array_sumscalar (Arraytype type, const char *p, int n,
+			     void *sum);
+
+/**
+ * @brief Find the first element of a numeric array equal to a value.
+ *
+ * @param[in] type The type of the elements.
+ * @param[in] p The memory address of the first element.
+ * @param[in] n The number of elements.
+ * @param[in] value The memory address of the value, or NULL to find the
+ * first element that is not NaN.
+ *
+ * @retval index The index of the first matching element.
+ * @retval n No element matches.
+ *
+ * Floating point elements are compared as numbers, so NaN matches nothing
+ * and -0 matches +0.
+ */
+static int array_findnumber (Arraytype type, const char *p, int n,
+			     const union Arrayvalue *value);
+
+/**
+ * @brief Scalar minimum and maximum kernel.
+ *
+ * A NaN element never replaces the current minimum or maximum.
+ *
+ * @param[in] type The type of the elements.
+ * @param[in] p The memory address of the first element.
+ * @param[in] n The number of elements.
+ * @param[in,out] min The memory address of the current minimum.
+ * @param[in,out] max The memory address of the current maximum.
+ */
+static void array_minmaxscalar (Arraytype type, const char *p, int n,
+				void *min, void *max);
+
+/**
+ * @brief Scalar inclusive prefix sum kernel.
+ *
+ * @param[in] type The type of the elements.
+ * @param[in,out] p The memory address of the first element.
+ * @param[in] n The number of elements.
+ * @param[in,out] carry The memory address of the sum of the previous
+ * elements, updated with the sum of these ones.
+ */
+static void array_prefixscalar (Arraytype type, char *p, int n, void *carry);
+
+/**
+ * @brief Scalar dot product kernel.
+ *
+ * @param[in] type The type of the elements.
+ * @param[in] p1 The memory address of the first element of the first array.
+ * @param[in] p2 The memory address of the first element of the second
+ * array.
+ * @param[in] n The number of elements.
+ * @param[in,out] dot The memory address of the partial dot product, as in
+ * array_dot, to which the products are added.
+ */
+static void array_dotscalar (Arraytype type, const char *p1, const char *p2,
+			     int n, void *dot);
+
+/**
+ * @brief Scalar axpy kernel.
+ *
+ * @param[in] type The type of the elements.
+ * @param[in,out] py The memory address of the first element of y.
+ * @param[in] px The memory address of the first element of x.
+ * @param[in] n The number of elements.
+ * @param[in] alpha The memory address of the scale factor.
+ */
+static void array_axpyscalar (Arraytype type, char *py, const char *px,
+			      int n, const void *alpha);
+
+#if defined (SALIBC_X86) || DOXYGEN
+
+/**
+ * @brief SSE2 version of array_sumscalar.
+ */
+static void array_sumsse2 (Arraytype type, const char *p, int n, void *sum)
+  __attribute__ ((target ("sse2")));
+
+/**
+ * @brief AVX2 version of array_sumscalar.
+ */
+static void array_sumavx2 (Arraytype type, const char *p, int n, void *sum)
+  __attribute__ ((target ("avx2")));
+
+/**
+ * @brief SSE2 version of array_minmaxscalar.
+ *
+ * @pre min and max must hold an element of the array that is not NaN.
+ */
+static void array_minmaxsse2 (Arraytype type, const char *p, int n,
+			      void *min, void *max)
+  __attribute__ ((target ("sse2")));
+
+/**
+ * @brief AVX2 version of array_minmaxscalar.
+ *
+ * @pre min and max must hold an element of the array that is not NaN.
+ */
+static void array_minmaxavx2 (Arraytype type, const char *p, int n,
+			      void *min, void *max)
+  __attribute__ ((target ("avx2")));
+
+/**
+ * @brief SSE2 version of array_prefixscalar.
+ *
+ * This is also used when AVX2 is available, since the running sum does not
+ * gain from wider registers.
+ */
+static void array_prefixsse2 (Arraytype type, char *p, int n, void *carry)
+  __attribute__ ((target ("sse2")));
+
+/**
+ * @brief SSE2 version of array_dotscalar.
+ */
+static void array_dotsse2 (Arraytype type, const char *p1, const char *p2,
+			   int n, void *dot)
+  __attribute__ ((target ("sse2")));
+
+/**
+ * @brief AVX2 version of array_dotscalar.
+ */
+static void array_dotavx2 (Arraytype type, const char *p1, const char *p2,
+			   int n, void *dot)
+  __attribute__ ((target ("avx2")));
+
+/**
+ * @brief SSE2 version of array_axpyscalar.
+ */
+static void array_axpysse2 (Arraytype type, char *py, const char *px, int n,
+			    const void *alpha)
+  __attribute__ ((target ("sse2")));
+
+/**
+ * @brief AVX2 version of array_axpyscalar.
+ */
+static void array_axpyavx2 (Arraytype type, char *py, const char *px, int n,
+			    const void *alpha)
+  __attribute__ ((target ("avx2")));
+#endif
+
+/**
+ * @brief Get the chunk that contains the specified index of a concurrent
+ * append array.
+ *
+ * @param[in] index A non negative index.
+ *
+ * @retval k The chunk number.
+ */
+static int concarray_chunkindex (int index);
+
+/**
+ * @brief Get the position of an index inside its chunk.
+ *
+ * @param[in] index A non negative index.
+ * @param[in] k The chunk number of the index.
+ *
+ * @retval offset The position inside the chunk.
+ */
+static size_t concarray_chunkoffset (int index, int k);
+
+/**
+ * @brief Get the number of elements contained in a chunk.
+ *
+ * @param[in] k The chunk number.
+ *
+ * @retval length The length of the chunk.
+ */
+static size_t concarray_chunklength (int k);
+
+/**
+ * @brief Get a chunk of a concurrent append array, allocating it if needed.
+ *
+ * @param[in] ca The pointer to a concurrent append array ADT instance.
+ * @param[in] k The chunk number.
+ *
+ * @retval chunk The memory address of the chunk.
+ *
+ * @warning This function may return NULL if some problem occured.
+ */
+static char *concarray_chunkalloc (Concarray ca, int k);
+
+/**
+ * @brief Get the memory address of the first word of a bit array.
+ *
+ * @param[in] b The pointer to a bit array ADT instance.
+ *
+ * @retval words The memory address of the words.
+ */
+static uint64_t *bitarray_words (Bitarray b);
+
+/**
+ * @brief Get the number of words of a bit array.
+ *
+ * @param[in] b The pointer to a bit array ADT instance.
+ *
+ * @retval nwords The number of words.
+ */
+static int bitarray_nwords (Bitarray b);
+
+/**
+ * @brief Check if two bit arrays can be combined word by word.
+ *
+ * @param[in] b1 The pointer to the first bit array ADT instance.
+ * @param[in] b2 The pointer to the second bit array ADT instance.
+ *
+ * @retval true The two bit arrays have the same length.
+ * @retval false The two bit arrays cannot be combined.
+ */
+static bool bitarray_compatible (Bitarray b1, Bitarray b2);
+
+/**
+ * @brief Rebuild the rank directory of a bit array if the bits changed.
+ *
+ * @param[in] b The pointer to a bit array ADT instance.
+ */
+static void bitarray_rankall (Bitarray b);
+
+/**
+ * @brief Apply a bulk operation to two bit arrays, storing the result in
+ * the first one.
+ *
+ * @param[in,out] b1 The pointer to the first bit array ADT instance.
+ * @param[in] b2 The pointer to the second bit array ADT instance.
+ * @param[in] op One of BITARRAY_AND, BITARRAY_OR, BITARRAY_XOR and
+ * BITARRAY_ANDNOT.
+ *
+ * @retval true Operation successful.
+ * @retval false The two bit arrays have different lengths.
+ */
+static bool bitarray_combine (Bitarray b1, Bitarray b2, int op);
+
+/**
+ * @brief Scalar bulk operation kernel.
+ *
+ * @param[in,out] w1 The words of the first bit array.
+ * @param[in] w2 The words of the second bit array.
+ * @param[in] n The number of words.
+ * @param[in] op The operation, as in bitarray_combine.
+ */
+static void bitarray_combinescalar (uint64_t *w1, const uint64_t *w2, int n,
+				    int op);
+
+#if defined (SALIBC_X86) || DOXYGEN
+
+/**
+ * @brief SSE2 version of bitarray_combinescalar.
+ */
+static void bitarray_combinesse2 (uint64_t *w1, const uint64_t *w2, int n,
+				  int op) __attribute__ ((target ("sse2")));
+
+/**
+ * @brief AVX2 version of bitarray_combinescalar.
+ */
+static void bitarray_combineavx2 (uint64_t *w1, const uint64_t *w2, int n,
+				  int op) __attribute__ ((target ("avx2")));
+#endif
+
+/**
+ * @brief Read an integer of the specified size.
+ *
+ * @param[in] element The memory address of a 4 or 8 byte integer.
+ * @param[in] size The size of the integer.
+ *
+ * @retval value The integer, widened to 64 bits.
+ */
+static uint64_t cintarray_load (void *element, size_t size);
+
+/**
+ * @brief Write an integer of the specified size.
+ *
+ * @param[out] element The memory address of a 4 or 8 byte integer.
+ * @param[in] size The size of the integer.
+ * @param[in] value The integer, truncated to size bytes.
+ */
+static void cintarray_store (void *element, size_t size, uint64_t value);
+
+/**
+ * @brief Get the size in bytes of the packed differences of a block.
+ *
+ * @param[in] width The bit width of the packed differences.
+ *
+ * @retval size The size of the packed differences, including a padding
+ * word.
+ */
+static size_t cintarray_packedsize (int width);
+
+/**
+ * @brief Get the size in bytes of an encoded block.
+ *
+ * @param[in] width The bit width of the packed differences.
+ * @param[in] nexceptions The number of exceptions of the block.
+ *
+ * @retval size The size of the block.
+ */
+static size_t cintarray_blocksize (int width, int nexceptions);
+
+/**
+ * @brief Encode the pending elements as a new block.
+ *
+ * @param[in] ca The pointer to a compressed integer array ADT instance.
+ *
+ * @retval true Encoding successful.
+ * @retval false Encoding unsuccessful.
+ */
+static bool cintarray_encode (Cintarray ca);
+
+/**
+ * @brief Decode the first elements of a block.
+ *
+ * @param[in] ca The pointer to a compressed integer array ADT instance.
+ * @param[in] block The block number.
+ * @param[out] values Where the decoded elements are stored.
+ * @param[in] count The number of elements to be decoded.
+ */
+static void cintarray_decode (Cintarray ca, int block, uint64_t * values,
+			      int count);
+
+/**
+ * @brief Unpack bit-packed values, selecting the kernel with array_simd.
+ *
+ * @param[in] packed The packed values, followed by a padding word.
+ * @param[in] width The bit width of each value.
+ * @param[out] values Where the unpacked values are stored.
+ * @param[in] n The number of values.
+ */
+static void cintarray_unpack (const char *packed, int width,
+			      uint64_t * values, int n);
+
+/**
+ * @brief Scalar unpack kernel.
+ *
+ * @param[in] packed The packed values, followed by a padding word.
+ * @param[in] width The bit width of each value.
+ * @param[out] values Where the unpacked values are stored.
+ * @param[in] first The first value to be unpacked.
+ * @param[in] n The number of values.
+ */
+static void cintarray_unpackscalar (const char *packed, int width,
+				    uint64_t * values, int first, int n);
+
+#if defined (SALIBC_X86) || DOXYGEN
+
+/**
+ * @brief SSE2 version of cintarray_unpack.
+ *
+ * Values up to 56 bits wide are read with one unaligned load each, so that
+ * two of them are shifted and masked at once.
+ */
+static void cintarray_unpacksse2 (const char *packed, int width,
+				  uint64_t * values, int n)
+  __attribute__ ((target ("sse2")));
+
+/**
+ * @brief AVX2 version of cintarray_unpack.
+ *
+ * Values up to 56 bits wide are gathered four at a time, each from the byte
+ * holding its first bit.
+ */
+static void cintarray_unpackavx2 (const char *packed, int width,
+				  uint64_t * values, int n)
+  __attribute__ ((target ("avx2")));
+#endif
+
+/*
+ ***************************
+ *General purpose methods. *
+ ***************************
+ */
+static bool
+element_null (void *element)
+{
+  return (element == NULL);
+}
+
+#if defined (MEMORY_OVERLAP_CHECK) || DOXYGEN
+
+/**
+ * @brief If this flag is defined memory_overlaps function will work normally,
+ * otherwise it will only return false. By default this flag is deactivated.
+ */
+#define MEMORY_OVERLAP_CHECK
+
+/**
+ * @note Since memory is not always allocated consecutively, the following
+ * controls may fail because only memory addresses are checked and the
+ * system does not know if the memory in between belongs to something else.
+ */
+static bool
+memory_overlaps (void *chunk1, void *chunk2, size_t fullsize)
+{
+  char *c1 = chunk1, *c2 = chunk2;
+
+  if (element_null (chunk1) || element_null (chunk2))
+    return false;
+
+  /* |-----------|
+   * |     |-----|-------|
+   * c1   c2  c1+fullsize  c2+smt
+   * c2   c1  c2+fullsize  c1+smt
+   *
+   */
+  return ((c1 <= c2) && (c1 + fullsize >= c2)) || ((c2 <= c1)
+						   && (c2 + fullsize >= c1));
+}
+#else
+static bool
+memory_overlaps (void *chunk1, void *chunk2, size_t fullsize)
+{
+  (void) chunk1;
+  (void) chunk2;
+  (void) fullsize;
+  return false;
+}
+#endif
+
+/*
+ ******************
+ * Mixed methods. *
+ ******************
+ */
+
+/**
+ * @note The non-ADT part of the array is deleted (as well as some fields of
+ * the ADT).
+ */
+static void
+realarray_delete (Array a)
+{
+  if (array_null (a))
+    return;
+
+  free (array_pointer (a));
+  a->ptr = NULL;
+  a->nmemb = 0;
+  a->capacity = 0;
+}
+
+/*
+ ***************************
+ * Array specific methods. *
+ ***************************
+ */
+static bool
+array_indexoutofbounds (Array a, int index)
+{
+  return ((index < 0) || (index > array_length (a) - 1));
+}
+
+static void
+array_writebegin (Array a)
+{
+  if (array_null (a->retired))
+    return;
+
+  __atomic_store_n (&a->seq, a->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+}
+
+static void
+array_writeend (Array a)
+{
+  if (array_null (a->retired))
+    return;
+
+  __atomic_store_n (&a->seq, a->seq + 1, __ATOMIC_RELEASE);
+}
+
+static unsigned int
+array_readbegin (Array a)
+{
+  unsigned int seq;
+
+  while ((seq = __atomic_load_n (&a->seq, __ATOMIC_ACQUIRE)) & 1)
+    ;
+
+  return seq;
+}
+
+static bool
+array_readretry (Array a, unsigned int seq)
+{
+  __atomic_thread_fence (__ATOMIC_ACQUIRE);
+  return (__atomic_load_n (&a->seq, __ATOMIC_RELAXED) != seq);
+}
+
+/**
+ * @note The buffer grows geometrically, so N appends replace it only
+ * O(log N) times. A resize within the capacity only changes the length; a
+ * new buffer is filled before being published, so readers only retry while
+ * the pointer and the length are swapped. The buffer is also replaced when
+ * the length drops below a quarter of the capacity, to give memory back.
+ */
+static bool
+array_concurrentresize (Array a, int new_length)
+{
+  char *tmp, *old = array_pointer (a);
+  int capacity = a->capacity;
+  size_t kept;
+  struct Arrayretired retired;
+
+  if (array_length (a) == new_length && new_length >= capacity / 4)
+    return true;
+
+  if (new_length <= capacity && new_length >= capacity / 4)
+    {
+      array_writebegin (a);
+      if (new_length > array_length (a))
+	memset (old + array_fullsize (a), 0,
+		array_size (a) * ((size_t) (new_length - array_length (a))));
+      __atomic_store_n (&a->nmemb, new_length, __ATOMIC_RELAXED);
+      array_writeend (a);
+      return true;
+    }
+
+  if (new_length > capacity)
+    capacity = capacity > INT_MAX / 2 || 2 * capacity < new_length ?
+      new_length : 2 * capacity;
+  else
+    capacity = new_length;
+  tmp = malloc (array_size (a) * ((size_t) capacity));
+  if (element_null (tmp) && capacity > 0)
+    return false;
+
+  kept = array_size (a) * ((size_t) (new_length < array_length (a) ?
+				      new_length : array_length (a)));
+  if (kept > 0)
+    memcpy (tmp, old, kept);
+  if (array_size (a) * ((size_t) new_length) > kept)
+    memset (tmp + kept, 0, array_size (a) * ((size_t) new_length) - kept);
+
+  retired.ptr = old;
+  retired.epoch = a->epoch;
+  if (!element_null (old) && !array_append (a->retired, &retired))
+    {
+      free (tmp);
+      return false;
+    }
+
+  array_writebegin (a);
+  __atomic_store_n (&a->ptr, tmp, __ATOMIC_RELAXED);
+  __atomic_store_n (&a->nmemb, new_length, __ATOMIC_RELAXED);
+  array_writeend (a);
+  a->capacity = capacity;
+
+  return true;
+}
+
+/**
+ * @note The length is not published, so readers in concurrent read mode
+ * keep seeing the same elements, whichever buffer they read.
+ */
+static bool
+array_reserve (Array a, int capacity)
+{
+  char *tmp, *old = array_pointer (a);
+  struct Arrayretired retired;
+
+  if (capacity <= a->capacity)
+    return true;
+
+  if (array_null (a->retired))
+    {
+      tmp = realloc (old, array_size (a) * ((size_t) capacity));
+      if (element_null (tmp))
+	return false;
+      a->ptr = tmp;
+      a->capacity = capacity;
+      return true;
+    }
+
+  if (a->capacity <= INT_MAX / 2 && 2 * a->capacity > capacity)
+    capacity = 2 * a->capacity;
+  tmp = malloc (array_size (a) * ((size_t) capacity));
+  if (element_null (tmp))
+    return false;
+  if (array_fullsize (a) > 0)
+    memcpy (tmp, old, array_fullsize (a));
+
+  retired.ptr = old;
+  retired.epoch = a->epoch;
+  if (!element_null (old) && !array_append (a->retired, &retired))
+    {
+      free (tmp);
+      return false;
+    }
+
+  array_writebegin (a);
+  __atomic_store_n (&a->ptr, tmp, __ATOMIC_RELAXED);
+  array_writeend (a);
+  a->capacity = capacity;
+
+  return true;
+}
+
+static void
+array_shrinktofit (Array a)
+{
+  char *tmp;
+
+  if (!array_null (a->retired))
+    array_concurrentresize (a, array_length (a));
+  else if (array_length (a) == 0)
+    realarray_delete (a);
+  else if (array_length (a) < a->capacity)
+    {
+      tmp = realloc (array_pointer (a), array_fullsize (a));
+      if (!element_null (tmp))
+	{
+	  a->ptr = tmp;
+	  a->capacity = array_length (a);
+	}
+    }
+}
+
+static void
+array_truncate (Array a, int new_length)
+{
+  int i;
+
+  if (!element_null (a->hashindex))
+    for (i = array_length (a) - 1; i >= new_length; i--)
+      hashindex_unlink (a, i);
+
+  array_writebegin (a);
+  __atomic_store_n (&a->nmemb, new_length, __ATOMIC_RELAXED);
+  array_writeend (a);
+  array_shrinktofit (a);
+}
+
+static Hashindex
+array_suspendindex (Array a)
+{
+  Hashindex hi = a->hashindex;
+
+  a->hashindex = NULL;
+  return hi;
+}
+
+static void
+array_resumeindex (Array a, Hashindex hi)
+{
+  if (element_null (hi))
+    return;
+
+  a->hashindex = hi;
+  if (!hashindex_build (a))
+    array_detachindex (a);
+}
+
+static int
+array_compare (size_t size, int (*cmp) (const void *, const void *),
+	       const void *e1, const void *e2)
+{
+  uint32_t x32, y32;
+  uint64_t x64, y64;
+
+  if (cmp != NULL)
+    return cmp (e1, e2);
+
+  if (size == sizeof (uint32_t))
+    {
+      memcpy (&x32, e1, sizeof (uint32_t));
+      memcpy (&y32, e2, sizeof (uint32_t));
+      return ((x32 > y32) - (x32 < y32));
+    }
+  else if (size == sizeof (uint64_t))
+    {
+      memcpy (&x64, e1, sizeof (uint64_t));
+      memcpy (&y64, e2, sizeof (uint64_t));
+      return ((x64 > y64) - (x64 < y64));
+    }
+
+  return memcmp (e1, e2, size);
+}
+
+/**
+ * @note The probes are at from, from + 1, from + 3, from + 7, ... until an
+ * element past the searched one is found, then the last interval is
+ * bisected.
+ */
+static int
+array_gallop (Array a, int from, void *element,
+	      int (*cmp) (const void *, const void *), bool upper)
+{
+  int lo = from, hi = from, step = 1, mid, c;
+
+  /*
+   * Every element before lo is before element, while hi is either past it
+   * or the length of the array.
+   */
+  while (hi < array_length (a))
+    {
+      c = array_compare (array_size (a), cmp, array_indexpointer (a, hi),
+			 element);
+      if (c > 0 || (c == 0 && !upper))
+	break;
+      lo = hi + 1;
+      hi = (step < array_length (a) - hi) ? hi + step : array_length (a);
+      step *= 2;
+    }
+
+  while (lo < hi)
+    {
+      mid = lo + (hi - lo) / 2;
+      c = array_compare (array_size (a), cmp, array_indexpointer (a, mid),
+			 element);
+      if (c > 0 || (c == 0 && !upper))
+	hi = mid;
+      else
+	lo = mid + 1;
+    }
+
+  return lo;
+}
+
+static void
+array_copyrange (Array out, int *count, Array a, int from, int to)
+{
+  if (to <= from)
+    return;
+
+  memcpy (array_pointer (out) + ((size_t) * count) * array_size (out),
+	  array_pointer (a) + ((size_t) from) * array_size (a),
+	  ((size_t) (to - from)) * array_size (a));
+  *count += to - from;
+}
+
+static Array
+array_setnew (Array a1, Array a2, long nmemb)
+{
+  if (array_null (a1) || array_null (a2)
+      || array_size (a1) != array_size (a2) || nmemb > INT_MAX)
+    return NULL;
+
+  return (array_new ((int) nmemb, array_size (a1)));
+}
+
+static Array
+array_setend (Array a, int count)
+{
+  if (!array_null (a) && !array_resize (a, count))
+    array_delete (&a);
+
+  return a;
+}
+
+#if defined (SALIBC_X86)
+
+/**
+ * @note Each block of a1 is compared with the four rotations of the current
+ * block of a2, then the block with the smaller maximum is skipped.
+ */
+static void
+array_intersectsse (Array a1, Array a2, int *i, int *j, Array a3, int *count)
+{
+  int k, mask;
+  uint32_t *p1 = (uint32_t *) array_pointer (a1);
+  uint32_t *p2 = (uint32_t *) array_pointer (a2);
+  uint32_t *p3 = (uint32_t *) array_pointer (a3);
+  __m128i v1, v2, eq;
+
+  while (*i + 4 <= array_length (a1) && *j + 4 <= array_length (a2))
+    {
+      v1 = _mm_loadu_si128 ((__m128i *) (p1 + *i));
+      v2 = _mm_loadu_si128 ((__m128i *) (p2 + *j));
+      eq = _mm_or_si128 (_mm_cmpeq_epi32 (v1, v2),
+			 _mm_cmpeq_epi32 (v1, _mm_shuffle_epi32 (v2, 0x39)));
+      eq = _mm_or_si128 (eq, _mm_cmpeq_epi32 (v1,
+					      _mm_shuffle_epi32 (v2, 0x4e)));
+      eq = _mm_or_si128 (eq, _mm_cmpeq_epi32 (v1,
+					      _mm_shuffle_epi32 (v2, 0x93)));
+      mask = _mm_movemask_ps (_mm_castsi128_ps (eq));
+      for (k = 0; k < 4; k++)
+	if (mask & (1 << k))
+	  p3[(*count)++] = p1[*i + k];
+
+      if (p1[*i + 3] <= p2[*j + 3])
+	*i += 4;
+      else
+	*j += 4;
+    }
+}
+#endif
+
+static void
+array_mergeload (Array a, struct Arraymergehead *head, int pos,
+		 int (*cmp) (const void *, const void *))
+{
+  uint32_t key32;
+
+  head->pos = pos;
+  head->ptr = array_pointer (a) + ((size_t) pos) * array_size (a);
+  if (cmp != NULL)
+    return;
+  if (array_size (a) == sizeof (uint32_t))
+    {
+      memcpy (&key32, head->ptr, sizeof (uint32_t));
+      head->key = key32;
+    }
+  else if (array_size (a) == sizeof (uint64_t))
+    memcpy (&head->key, head->ptr, sizeof (uint64_t));
+}
+
+/**
+ * @note Ties go to the array with the lower number, so that the merge is
+ * stable.
+ */
+static bool
+array_heapbefore (struct Arraymergehead *heads, size_t size,
+		  int (*cmp) (const void *, const void *), int x, int y)
+{
+  int c;
+
+  if (cmp != NULL)
+    c = cmp (heads[x].ptr, heads[y].ptr);
+  else if (size == sizeof (uint32_t) || size == sizeof (uint64_t))
+    c = (heads[x].key > heads[y].key) - (heads[x].key < heads[y].key);
+  else
+    c = memcmp (heads[x].ptr, heads[y].ptr, size);
+
+  return (c < 0 || (c == 0 && x < y));
+}
+
+static void
+array_siftdown (struct Arraymergehead *heads, int *heap, int n, int root,
+		size_t size, int (*cmp) (const void *, const void *))
+{
+  int child, top = heap[root];
+
+  while ((child = 2 * root + 1) < n)
+    {
+      if (child + 1 < n
+	  && array_heapbefore (heads, size, cmp, heap[child + 1],
+			       heap[child]))
+	child++;
+      if (!array_heapbefore (heads, size, cmp, heap[child], top))
+	break;
+      heap[root] = heap[child];
+      root = child;
+    }
+  heap[root] = top;
+}
+
+static char *
+array_indexpointer (Array a, int index)
+{
+  if (array_null (a))
+    return NULL;
+
+  /* Array bound check. */
+  if (array_indexoutofbounds (a, index))
+    return NULL;
+
+  return (array_pointer (a) + (((size_t) index) * array_size (a)));
+}
+
+/**
+ * @note It is assumed that element has the same size of a->ptr.
+ */
+static bool
+array_memcopy (Array a, int index, void *element)
+{
+  if (array_null (a))
+    return false;
+
+  /**
+   * @note Even though the array_indexoutofbounds function is called inside the
+   * array_indexpointer function, this returns NULL, so memcpy would be done
+   * on a dest of NULL. That's why we need to call that function here as well
+   */
+   /** @code */
+  if (!element_null (element)
+      && !memory_overlaps (a, element, array_fullsize (a))
+      && !array_indexoutofbounds (a, index))
+    {
+      if (!element_null (a->hashindex))
+	hashindex_unlink (a, index);
+      array_writebegin (a);
+      memcpy (array_indexpointer (a, index), element, array_size (a));
+      array_writeend (a);
+      if (!element_null (a->hashindex) && !hashindex_link (a, index))
+	array_detachindex (a);
+      return true;
+    }
+  /** @endcode */
+  else
+    return false;
+}
+
+bool
+array_null (Array a)
+{
+  return (element_null (a));
+}
+
+bool
+array_empty (Array a)
+{
+  assert (!array_null (a));
+  return (array_length (a) == 0);
+}
+
+size_t
+array_size (Array a)
+{
+  assert (!array_null (a));
+  return (a->size);
+}
+
+int
+array_length (Array a)
+{
+  assert (!array_null (a));
+  return (a->nmemb);
+}
+
+/**
+ * @note This function should not return an out of bound value.
+ */
+size_t
+array_fullsize (Array a)
+{
+  assert (!array_null (a));
+  return (((size_t) array_length (a)) * array_size (a));
+}
+
+char *
+array_pointer (Array a)
+{
+  if (array_null (a))
+    return NULL;
+
+  return (a->ptr);
+}
+
+/**
+ * @note memcmp works well in checking equality even for floating point
+ * numbers.
+ */
+bool
+array_equal (Array a1, Array a2)
+{
+  if (array_null (a1) || array_null (a2))
+    return false;
+
+  if ((array_length (a1) == array_length (a2))
+      && (array_fullsize (a1) == array_fullsize (a2))
+      && (memcmp (array_pointer (a1), array_pointer (a2), array_fullsize (a1))
+	  == 0))
+    return true;
+
+  return false;
+}
+
+/**
+ * @note This function is also known as the array constructor.
+ */
+Array
+array_new (int nmemb, size_t size)
+{
+  Array new_array = NULL;
+
+  if (nmemb >= 0 && size > 0)
+    {
+      new_array = malloc (sizeof (struct Array));
+      if (element_null (new_array))
+	return NULL;
+
+      new_array->size = size;
+      new_array->nmemb = nmemb;
+      new_array->seq = 0;
+      new_array->capacity = nmemb;
+      new_array->retired = NULL;
+      new_array->epoch = 0;
+      new_array->readers[0] = 0;
+      new_array->readers[1] = 0;
+      new_array->hashindex = NULL;
+      new_array->ptr = calloc (nmemb, size);
+      if (element_null (array_pointer (new_array)))
+	array_delete (&new_array);
+    }
+
+  return new_array;
+}
+
+void
+array_delete (Array * a_ref)
+{
+  if (!element_null (a_ref) && !array_null (*a_ref))
+    {
+      realarray_delete (*a_ref);
+      if (!array_null ((*a_ref)->retired))
+	array_freeretired (*a_ref, UINT64_MAX);
+      array_delete (&(*a_ref)->retired);
+      array_detachindex (*a_ref);
+      (*a_ref)->size = 0;
+      free (*a_ref);
+      *a_ref = NULL;
+    }
+}
+
+bool
+array_put (Array a, int index, void *element)
+{
+  return (array_memcopy (a, index, element));
+}
+
+
+bool
+array_set (Array a, void *element)
+{
+  int i;
+
+  for (i = 0; i < array_length (a); i++)
+    {
+      if (!array_memcopy (a, i, element))
+	return false;
+    }
+
+  return true;
+}
+
+/**
+ * @note This function is an interface to array_indexpointer.
+ */
+char *
+array_get (Array a, int index)
+{
+  return (array_indexpointer (a, index));
+}
+
+Array
+array_copy (Array a1)
+{
+  int i;
+  Array a2;
+
+  if (array_null (a1))
+    return NULL;
+
+  /**
+   * @note Allocate a new array with the same ADT characteristics.
+   */
+  /** @code */
+  a2 = array_new (array_length (a1), array_size (a1));
+  if (array_null (a2))
+    return NULL;
+  /** @endcode */
+
+  /**
+   * @note Copy the real array using the previously defined functions.
+   */
+  /** @code */
+  for (i = 0; i < array_length (a1); i++)
+    if (!array_memcopy (a2, i, array_indexpointer (a1, i)))
+      return NULL;
+  /** @endcode */
+
+  return a2;
+}
+
+/**
+ * @note The indexes that are removed are unlinked from the hash index
+ * before the resize, while the new ones are linked after it.
+ */
+bool
+array_resize (Array a, int new_length)
+{
+  int i, initial_length;
+
+  if (array_null (a) || element_null (a->hashindex) || new_length < 0)
+    return (array_realresize (a, new_length));
+
+  initial_length = array_length (a);
+  for (i = initial_length - 1; i >= new_length; i--)
+    hashindex_unlink (a, i);
+
+  if (!array_realresize (a, new_length))
+    {
+      for (i = new_length; i < initial_length; i++)
+	hashindex_link (a, i);
+      return false;
+    }
+
+  if (new_length > initial_length
+      && (!array_resize (a->hashindex->next, new_length)
+	  || !array_resize (a->hashindex->prev, new_length)))
+    {
+      array_detachindex (a);
+      return true;
+    }
+  for (i = initial_length; i < new_length; i++)
+    if (!hashindex_link (a, i))
+      {
+	array_detachindex (a);
+	break;
+      }
+
+  return true;
+}
+
+static bool
+array_realresize (Array a, int new_length)
+{
+  char *tmp;
+  int memdiff;
+
+  if (array_null (a))
+    return NULL;
+
+  /** @code */
+  /*
+   * Invalid new length.
+   */
+  if (new_length < 0)
+    return false;
+  /*
+   * Readers may still be using the current buffer, so it must not be
+   * reallocated.
+   */
+  else if (!array_null (a->retired))
+    return array_concurrentresize (a, new_length);
+  /*
+   * new_length is set to zero, so leave the ADT, but delete internal array.
+   */
+  else if (new_length == 0)
+    {
+      realarray_delete (a);
+      return true;
+    }
+  /*
+   * Same size as before, then do nothing.
+   */
+  else if (array_length (a) == new_length)
+    return true;
+  /*
+   * Array's length != new_length, so realloc can now be used directly.
+   */
+  else
+    {
+      /*
+       * Safe realloc (to avoid losing the stored array if realloc fails).
+       */
+      tmp = realloc (array_pointer (a), array_size (a) * ((size_t) new_length));
+      if (!element_null (tmp))
+	a->ptr = tmp;
+      else
+	return false;
+      /*
+       * memset to 0 new part of the array.
+       * To do this we must go to the first byte of the new part of the array
+       * and put 0 until we get to (memdiff * a->size) bytes.
+       */
+      memdiff = new_length - array_length (a);
+      if (memdiff > 0)
+	memset (array_pointer (a) + array_fullsize (a), 0,
+		((size_t) memdiff) * array_size (a));
+
+      /*
+       * Set the new array length.
+       */
+      a->nmemb = new_length;
+      a->capacity = new_length;
+    }
+
+  return true;
+  /** @endcode */
+}
+
+/**
+ * @note This function alters the input.
+ */
+bool
+array_append (Array a, void *element)
+{
+  int initial_length = array_length (a);
+
+  if (array_resize (a, initial_length + 1)
+      && array_memcopy (a, initial_length, element))
+    return true;
+  else
+    return false;
+}
+
+char *
+array_trim (Array a)
+{
+  int initial_length = array_length (a);
+  char *element, *element_copy;
+
+  /**
+   * @note Copy *element int *element_copy.
+   */
+  /** @code */
+  element = array_indexpointer (a, initial_length - 1);
+  element_copy = malloc (array_size (a));
+  memcpy (element_copy, element, array_size (a));
+  /** @endcode */
+
+  if (!element_null (element_copy) && array_resize (a, initial_length - 1))
+    return element_copy;
+  else
+    return NULL;
+}
+
+/**
+ * @note Each input is copied with a single memcpy.
+ */
+Array
+array_merge (Array a1, Array a2)
+{
+  Array new_array;
+
+  /**
+   * @note Safety controls.
+   */
+  /** @code */
+  if (array_null (a1) || array_null (a2)
+      || (array_size (a1) != array_size (a2))
+      || array_length (a1) > INT_MAX - array_length (a2))
+    return NULL;
+  /** @endcode */
+
+  new_array =
+    array_new (array_length (a1) + array_length (a2), array_size (a1));
+  if (array_null (new_array))
+    return NULL;
+
+  memcpy (array_pointer (new_array), array_pointer (a1), array_fullsize (a1));
+  memcpy (array_pointer (new_array) + array_fullsize (a1), array_pointer (a2),
+	  array_fullsize (a2));
+
+  return new_array;
+}
+
+/**
+ * @note The tail of the array is shifted with a single memmove. Room is
+ * made first, so in concurrent read mode the shifted elements and the new
+ * length are published together.
+ */
+bool
+array_insertrange (Array a, int index, void *elements, int nmemb)
+{
+  int initial_length;
+  Hashindex hi;
+
+  if (array_null (a) || element_null (elements) || nmemb < 0)
+    return false;
+
+  initial_length = array_length (a);
+  if (index < 0 || index > initial_length || nmemb > INT_MAX - initial_length)
+    return false;
+  if (nmemb == 0)
+    return true;
+
+  if (!array_reserve (a, initial_length + nmemb))
+    return false;
+
+  hi = array_suspendindex (a);
+  array_writebegin (a);
+  memmove (array_pointer (a) + ((size_t) (index + nmemb)) * array_size (a),
+	   array_pointer (a) + ((size_t) index) * array_size (a),
+	   ((size_t) (initial_length - index)) * array_size (a));
+  memcpy (array_pointer (a) + ((size_t) index) * array_size (a), elements,
+	  ((size_t) nmemb) * array_size (a));
+  __atomic_store_n (&a->nmemb, initial_length + nmemb, __ATOMIC_RELAXED);
+  array_writeend (a);
+  array_resumeindex (a, hi);
+
+  return true;
+}
+
+bool
+array_insert (Array a, int index, void *element)
+{
+  return (array_insertrange (a, index, element, 1));
+}
+
+/**
+ * @note The tail of the array is shifted with a single memmove, and the new
+ * length is published with it. The buffer is shrunk afterwards, which
+ * cannot fail.
+ */
+bool
+array_eraserange (Array a, int index, int nmemb)
+{
+  int initial_length;
+  Hashindex hi;
+
+  if (array_null (a) || nmemb < 0)
+    return false;
+
+  initial_length = array_length (a);
+  if (index < 0 || index > initial_length - nmemb)
+    return false;
+  if (nmemb == 0)
+    return true;
+
+  hi = array_suspendindex (a);
+  array_writebegin (a);
+  memmove (array_pointer (a) + ((size_t) index) * array_size (a),
+	   array_pointer (a) + ((size_t) (index + nmemb)) * array_size (a),
+	   ((size_t) (initial_length - index - nmemb)) * array_size (a));
+  __atomic_store_n (&a->nmemb, initial_length - nmemb, __ATOMIC_RELAXED);
+  array_writeend (a);
+  array_shrinktofit (a);
+  array_resumeindex (a, hi);
+
+  return true;
+}
+
+bool
+array_erase (Array a, int index)
+{
+  return (array_eraserange (a, index, 1));
+}
+
+/**
+ * @note This is done in a single linear pass: kept elements are moved
+ * towards the head of the array and the new length is published with them,
+ * then the buffer is shrunk once.
+ */
+bool
+array_removeif (Array a, bool (*pred) (void *, void *), void *ctx)
+{
+  int i, kept = 0;
+  char *element;
+  Hashindex hi;
+
+  if (array_null (a) || pred == NULL)
+    return false;
+
+  hi = array_suspendindex (a);
+  array_writebegin (a);
+  for (i = 0; i < array_length (a); i++)
+    {
+      element = array_pointer (a) + ((size_t) i) * array_size (a);
+      if (!pred (element, ctx))
+	{
+	  if (kept != i)
+	    memcpy (array_pointer (a) + ((size_t) kept) * array_size (a),
+		    element, array_size (a));
+	  kept++;
+	}
+    }
+  __atomic_store_n (&a->nmemb, kept, __ATOMIC_RELAXED);
+  array_writeend (a);
+  array_shrinktofit (a);
+  array_resumeindex (a, hi);
+
+  return true;
+}
+
+/**
+ * @note Like array_removeif, this is done in a single linear pass.
+ */
+bool
+array_unique (Array a, int (*cmp) (const void *, const void *))
+{
+  int i, kept = 0;
+  char *element, *last;
+  Hashindex hi;
+
+  if (array_null (a))
+    return false;
+
+  hi = array_suspendindex (a);
+  array_writebegin (a);
+  for (i = 0; i < array_length (a); i++)
+    {
+      element = array_pointer (a) + ((size_t) i) * array_size (a);
+      if (kept > 0)
+	{
+	  last = array_pointer (a) + ((size_t) (kept - 1)) * array_size (a);
+	  if ((cmp == NULL ? memcmp (last, element, array_size (a))
+	       : cmp (last, element)) == 0)
+	    continue;
+	}
+      if (kept != i)
+	memcpy (array_pointer (a) + ((size_t) kept) * array_size (a), element,
+		array_size (a));
+      kept++;
+    }
+  __atomic_store_n (&a->nmemb, kept, __ATOMIC_RELAXED);
+  array_writeend (a);
+  array_shrinktofit (a);
+  array_resumeindex (a, hi);
+
+  return true;
+}
+
+/**
+ * @note Runs are found by galloping and copied with memcpy, so merging a
+ * small array into a large one only costs a few comparisons per element of
+ * the small array.
+ */
+Array
+array_mergesorted (Array a1, Array a2,
+		   int (*cmp) (const void *, const void *))
+{
+  int i = 0, j = 0, next, count = 0;
+  Array a3;
+
+  a3 = array_setnew (a1, a2, (long) array_length (a1) + array_length (a2));
+  if (array_null (a3))
+    return NULL;
+
+  while (i < array_length (a1) && j < array_length (a2))
+    {
+      next = array_gallop (a1, i, array_indexpointer (a2, j), cmp, true);
+      array_copyrange (a3, &count, a1, i, next);
+      i = next;
+      if (i == array_length (a1))
+	break;
+      next = array_gallop (a2, j, array_indexpointer (a1, i), cmp, false);
+      array_copyrange (a3, &count, a2, j, next);
+      j = next;
+    }
+  array_copyrange (a3, &count, a1, i, array_length (a1));
+  array_copyrange (a3, &count, a2, j, array_length (a2));
+
+  return (array_setend (a3, count));
+}
+
+/**
+ * @note A binary heap holds the arrays that still have elements, ordered
+ * by their current element. The array at the top is copied up to the head
+ * of the next array in the heap, which is found by galloping, so long runs
+ * cost a few comparisons instead of a heap update per element.
+ */
+Array
+array_mergek (Array * arrays, int k, int (*cmp) (const void *, const void *))
+{
+  int i, j, n = 0, next, count = 0, *heap;
+  long total = 0;
+  size_t size;
+  struct Arraymergehead *heads;
+  Array a, heap_array, heads_array;
+
+  if (element_null (arrays) || k <= 0)
+    return NULL;
+
+  for (i = 0; i < k; i++)
+    {
+      if (array_null (arrays[i])
+	  || array_size (arrays[i]) != array_size (arrays[0]))
+	return NULL;
+      total += array_length (arrays[i]);
+    }
+  if (total > INT_MAX)
+    return NULL;
+
+  size = array_size (arrays[0]);
+  a = array_new ((int) total, size);
+  heap_array = array_new (k, sizeof (int));
+  heads_array = array_new (k, sizeof (struct Arraymergehead));
+  if (array_null (a) || array_null (heap_array) || array_null (heads_array))
+    {
+      array_delete (&a);
+      array_delete (&heap_array);
+      array_delete (&heads_array);
+      return NULL;
+    }
+
+  heap = (int *) array_pointer (heap_array);
+  heads = (struct Arraymergehead *) array_pointer (heads_array);
+  for (i = 0; i < k; i++)
+    if (!array_empty (arrays[i]))
+      {
+	array_mergeload (arrays[i], &heads[i], 0, cmp);
+	heap[n++] = i;
+      }
+  for (i = n / 2 - 1; i >= 0; i--)
+    array_siftdown (heads, heap, n, i, size, cmp);
+
+  while (n > 0)
+    {
+      i = heap[0];
+      next = array_length (arrays[i]);
+      if (n > 1)
+	{
+	  /*
+	   * The next array is one of the children of the top. Equal
+	   * elements are taken from i only if it has the lower number.
+	   */
+	  j = heap[1];
+	  if (n > 2 && array_heapbefore (heads, size, cmp, heap[2], j))
+	    j = heap[2];
+	  next = array_gallop (arrays[i], heads[i].pos + 1, heads[j].ptr,
+			       cmp, i < j);
+	}
+      array_copyrange (a, &count, arrays[i], heads[i].pos, next);
+      if (next == array_length (arrays[i]))
+	heap[0] = heap[--n];
+      else
+	array_mergeload (arrays[i], &heads[i], next, cmp);
+      array_siftdown (heads, heap, n, 0, size, cmp);
+    }
+
+  array_delete (&heap_array);
+  array_delete (&heads_array);
+
+  return a;
+}
+
+/**
+ * @note Both arrays are walked by galloping, so the cost adapts to skewed
+ * sizes. With 32 bit elements, no comparison function and lengths within a
+ * factor ARRAY_SKEW of each other, blocks of four elements are compared at
+ * once with SSE2, if array_simd allows it; the block loop walks the longer
+ * array linearly, so it would lose against galloping on skewed sizes.
+ */
+Array
+array_intersect (Array a1, Array a2, int (*cmp) (const void *, const void *))
+{
+  int i = 0, j = 0, c, count = 0;
+  Array a3;
+
+  a3 = array_setnew (a1, a2, array_length (a1) < array_length (a2) ?
+		     array_length (a1) : array_length (a2));
+  if (array_null (a3))
+    return NULL;
+
+#if defined (SALIBC_X86)
+  if (array_simd () >= ARRAY_SSE2 && cmp == NULL
+      && array_size (a1) == sizeof (uint32_t)
+      && array_length (a1) / ARRAY_SKEW < array_length (a2)
+      && array_length (a2) / ARRAY_SKEW < array_length (a1))
+    array_intersectsse (a1, a2, &i, &j, a3, &count);
+#endif
+
+  while (i < array_length (a1) && j < array_length (a2))
+    {
+      c = array_compare (array_size (a1), cmp, array_indexpointer (a1, i),
+			 array_indexpointer (a2, j));
+      if (c < 0)
+	i = array_gallop (a1, i, array_indexpointer (a2, j), cmp, false);
+      else if (c > 0)
+	j = array_gallop (a2, j, array_indexpointer (a1, i), cmp, false);
+      else
+	{
+	  array_copyrange (a3, &count, a1, i, i + 1);
+	  i++;
+	  j++;
+	}
+    }
+
+  return (array_setend (a3, count));
+}
+
+Array
+array_union (Array a1, Array a2, int (*cmp) (const void *, const void *))
+{
+  int i = 0, j = 0, next, count = 0;
+  Array a3;
+
+  a3 = array_setnew (a1, a2, (long) array_length (a1) + array_length (a2));
+  if (array_null (a3))
+    return NULL;
+
+  while (i < array_length (a1) && j < array_length (a2))
+    {
+      next = array_gallop (a1, i, array_indexpointer (a2, j), cmp, false);
+      array_copyrange (a3, &count, a1, i, next);
+      i = next;
+      if (i == array_length (a1))
+	break;
+      /*
+       * Equal elements are taken only once, from a1.
+       */
+      if (array_compare (array_size (a1), cmp, array_indexpointer (a1, i),
+			 array_indexpointer (a2, j)) == 0)
+	j++;
+      else
+	{
+	  next = array_gallop (a2, j, array_indexpointer (a1, i), cmp, false);
+	  array_copyrange (a3, &count, a2, j, next);
+	  j = next;
+	}
+    }
+  array_copyrange (a3, &count, a1, i, array_length (a1));
+  array_copyrange (a3, &count, a2, j, array_length (a2));
+
+  return (array_setend (a3, count));
+}
+
+Array
+array_difference (Array a1, Array a2, int (*cmp) (const void *, const void *))
+{
+  int i = 0, j = 0, next, count = 0;
+  Array a3;
+
+  a3 = array_setnew (a1, a2, array_length (a1));
+  if (array_null (a3))
+    return NULL;
+
+  while (i < array_length (a1) && j < array_length (a2))
+    {
+      next = array_gallop (a1, i, array_indexpointer (a2, j), cmp, false);
+      array_copyrange (a3, &count, a1, i, next);
+      i = next;
+      if (i == array_length (a1))
+	break;
+      if (array_compare (array_size (a1), cmp, array_indexpointer (a1, i),
+			 array_indexpointer (a2, j)) == 0)
+	{
+	  i++;
+	  j++;
+	}
+      else
+	j = array_gallop (a2, j, array_indexpointer (a1, i), cmp, false);
+    }
+  array_copyrange (a3, &count, a1, i, array_length (a1));
+
+  return (array_setend (a3, count));
+}
+
+bool
+array_setconcurrent (Array a)
+{
+  if (array_null (a))
+    return false;
+
+  if (array_null (a->retired))
+    a->retired = array_new (0, sizeof (struct Arrayretired));
+
+  return (!array_null (a->retired));
+}
+
+/**
+ * @note This function never takes a lock: it retries until it gets a
+ * snapshot that no writer changed in the meantime.
+ */
+bool
+array_read (Array a, int index, void *element)
+{
+  unsigned int seq;
+  int parity;
+  char *ptr;
+  bool found;
+
+  if (array_null (a) || element_null (element))
+    return false;
+
+  parity = array_readenter (a);
+  do
+    {
+      seq = array_readbegin (a);
+      ptr = __atomic_load_n (&a->ptr, __ATOMIC_RELAXED);
+      found = (index >= 0
+	       && index < __atomic_load_n (&a->nmemb, __ATOMIC_RELAXED));
+      if (found)
+	memcpy (element, ptr + ((size_t) index) * array_size (a),
+		array_size (a));
+    }
+  while (array_readretry (a, seq));
+  array_readexit (a, parity);
+
+  return found;
+}
+
+int
+array_readlength (Array a)
+{
+  unsigned int seq;
+  int length;
+
+  assert (!array_null (a));
+  do
+    {
+      seq = array_readbegin (a);
+      length = __atomic_load_n (&a->nmemb, __ATOMIC_RELAXED);
+    }
+  while (array_readretry (a, seq));
+
+  return length;
+}
+
+/**
+ * @note The reader increments its counter and then checks that the epoch
+ * did not change, while array_reclaim checks the counter and then advances
+ * the epoch. Both are sequentially consistent, so either the reader sees
+ * the new epoch and retries, or array_reclaim sees the reader.
+ */
+static int
+array_readenter (Array a)
+{
+  uint64_t epoch;
+  int parity;
+
+  for (;;)
+    {
+      epoch = __atomic_load_n (&a->epoch, __ATOMIC_SEQ_CST);
+      parity = (int) (epoch & 1);
+      __atomic_fetch_add (&a->readers[parity], 1, __ATOMIC_SEQ_CST);
+      if (__atomic_load_n (&a->epoch, __ATOMIC_SEQ_CST) == epoch)
+	return parity;
+      __atomic_fetch_sub (&a->readers[parity], 1, __ATOMIC_RELEASE);
+    }
+}
+
+static void
+array_readexit (Array a, int parity)
+{
+  __atomic_fetch_sub (&a->readers[parity], 1, __ATOMIC_RELEASE);
+}
+
+static void
+array_freeretired (Array a, uint64_t bound)
+{
+  int i, kept = 0;
+  struct Arrayretired *retired;
+
+  retired = (struct Arrayretired *) array_pointer (a->retired);
+  for (i = 0; i < array_length (a->retired); i++)
+    if (retired[i].epoch < bound)
+      free (retired[i].ptr);
+    else
+      retired[kept++] = retired[i];
+  array_resize (a->retired, kept);
+}
+
+/**
+ * @note Active readers can only have started in the current epoch or in
+ * the previous one, because the epoch is only advanced when no reader of
+ * the previous one is left.
+ */
+void
+array_reclaim (Array a)
+{
+  uint64_t epoch;
+
+  if (array_null (a) || array_null (a->retired))
+    return;
+
+  epoch = a->epoch;
+  if (__atomic_load_n (&a->readers[(epoch + 1) & 1], __ATOMIC_SEQ_CST) == 0)
+    {
+      array_freeretired (a, epoch);
+      __atomic_store_n (&a->epoch, epoch + 1, __ATOMIC_SEQ_CST);
+    }
+  else if (epoch > 0)
+    array_freeretired (a, epoch - 1);
+}
+
+/*
+ ********************************
+ * Hash index specific methods. *
+ ********************************
+ */
+
+/**
+ * @note The mixers are the finalizers of MurmurHash3 and SplitMix64.
+ */
+static uint32_t
+hashindex_hash (void *element, size_t size)
+{
+  uint32_t x32;
+  uint64_t x, y;
+  size_t i;
+  unsigned char *bytes = element;
+
+  if (size == sizeof (uint32_t))
+    {
+      memcpy (&x32, element, sizeof (uint32_t));
+      x32 ^= x32 >> 16;
+      x32 *= UINT32_C (0x85ebca6b);
+      x32 ^= x32 >> 13;
+      x32 *= UINT32_C (0xc2b2ae35);
+      return (x32 ^ (x32 >> 16));
+    }
+
+  x = 0;
+  if (size == sizeof (uint64_t))
+    memcpy (&x, element, sizeof (uint64_t));
+  else if (size == 2 * sizeof (uint64_t))
+    {
+      memcpy (&x, element, sizeof (uint64_t));
+      memcpy (&y, bytes + sizeof (uint64_t), sizeof (uint64_t));
+      x ^= (y << 31 | y >> 33) * UINT64_C (0x9e3779b97f4a7c15);
+    }
+  else
+    /*
+     * FNV-1a for the other sizes.
+     */
+    for (i = 0, x = UINT64_C (0xcbf29ce484222325); i < size; i++)
+      x = (x ^ bytes[i]) * UINT64_C (0x100000001b3);
+
+  x ^= x >> 30;
+  x *= UINT64_C (0xbf58476d1ce4e5b9);
+  x ^= x >> 27;
+  x *= UINT64_C (0x94d049bb133111eb);
+  x ^= x >> 31;
+
+  return ((uint32_t) x);
+}
+
+static struct Hashslot *
+hashindex_slots (Hashindex hi)
+{
+  return ((struct Hashslot *) array_pointer (hi->slots));
+}
+
+/**
+ * @note Linear probing: the search stops at the first empty slot.
+ */
+static int
+hashindex_lookup (Array a, void *element, uint32_t hash)
+{
+  Hashindex hi = a->hashindex;
+  struct Hashslot *slots = hashindex_slots (hi);
+  uint32_t mask = (uint32_t) array_length (hi->slots) - 1;
+  uint32_t i;
+
+  for (i = hash & mask; slots[i].head != HASHINDEX_EMPTY; i = (i + 1) & mask)
+    if (slots[i].head >= 0 && slots[i].hash == hash
+	&& memcmp (array_indexpointer (a, slots[i].head), element,
+		   array_size (a)) == 0)
+      return ((int) i);
+
+  return -1;
+}
+
+static bool
+hashindex_rehash (Hashindex hi, int capacity)
+{
+  int i;
+  uint32_t j, mask = (uint32_t) capacity - 1;
+  struct Hashslot empty = { 0, HASHINDEX_EMPTY }, *old, *slots;
+  Array new_slots;
+
+  new_slots = array_new (capacity, sizeof (struct Hashslot));
+  if (array_null (new_slots) || !array_set (new_slots, &empty))
+    {
+      array_delete (&new_slots);
+      return false;
+    }
+
+  old = hashindex_slots (hi);
+  slots = (struct Hashslot *) array_pointer (new_slots);
+  for (i = 0; i < array_length (hi->slots); i++)
+    if (old[i].head >= 0)
+      {
+	for (j = old[i].hash & mask; slots[j].head != HASHINDEX_EMPTY;
+	     j = (j + 1) & mask)
+	  ;
+	slots[j] = old[i];
+      }
+
+  array_delete (&hi->slots);
+  hi->slots = new_slots;
+  hi->tombstones = 0;
+
+  return true;
+}
+
+/**
+ * @note The index becomes the head of the list of the indexes holding the
+ * same value.
+ */
+static bool
+hashindex_link (Array a, int index)
+{
+  Hashindex hi = a->hashindex;
+  struct Hashslot *slots;
+  char *element = array_indexpointer (a, index);
+  int *next = (int *) array_pointer (hi->next);
+  int *prev = (int *) array_pointer (hi->prev);
+  int capacity = array_length (hi->slots), slot;
+  uint32_t i, mask, hash = hashindex_hash (element, array_size (a));
+
+  /*
+   * Keep the load factor, tombstones included, under 3/4. The capacity is
+   * a power of two of at least HASHINDEX_MINSLOTS, so the divisions are
+   * exact, and they keep the comparisons from overflowing.
+   */
+  if (hi->used + hi->tombstones >= capacity / 4 * 3)
+    {
+      while (capacity < HASHINDEX_MAXSLOTS && capacity / 2 < hi->used + 1)
+	capacity *= 2;
+      if (hi->used >= capacity / 4 * 3 || !hashindex_rehash (hi, capacity))
+	return false;
+    }
+
+  slots = hashindex_slots (hi);
+  slot = hashindex_lookup (a, element, hash);
+  if (slot >= 0)
+    {
+      next[index] = slots[slot].head;
+      prev[slots[slot].head] = index;
+    }
+  else
+    {
+      mask = (uint32_t) array_length (hi->slots) - 1;
+      for (i = hash & mask; slots[i].head >= 0; i = (i + 1) & mask)
+	;
+      if (slots[i].head == HASHINDEX_TOMBSTONE)
+	hi->tombstones--;
+      hi->used++;
+      slot = (int) i;
+      slots[slot].hash = hash;
+      next[index] = HASHINDEX_EMPTY;
+    }
+  prev[index] = HASHINDEX_EMPTY;
+  slots[slot].head = index;
+
+  return true;
+}
+
+static void
+hashindex_unlink (Array a, int index)
+{
+  Hashindex hi = a->hashindex;
+  struct Hashslot *slots = hashindex_slots (hi);
+  int *next = (int *) array_pointer (hi->next);
+  int *prev = (int *) array_pointer (hi->prev);
+  uint32_t i, mask = (uint32_t) array_length (hi->slots) - 1;
+
+  if (prev[index] != HASHINDEX_EMPTY)
+    {
+      next[prev[index]] = next[index];
+      if (next[index] != HASHINDEX_EMPTY)
+	prev[next[index]] = prev[index];
+      return;
+    }
+
+  /*
+   * The index is the head of its list, so its slot must be updated.
+   */
+  for (i = hashindex_hash (array_indexpointer (a, index), array_size (a))
+       & mask; slots[i].head != index; i = (i + 1) & mask)
+    assert (slots[i].head != HASHINDEX_EMPTY);
+
+  if (next[index] != HASHINDEX_EMPTY)
+    {
+      slots[i].head = next[index];
+      prev[next[index]] = HASHINDEX_EMPTY;
+    }
+  else
+    {
+      slots[i].head = HASHINDEX_TOMBSTONE;
+      hi->used--;
+      hi->tombstones++;
+    }
+}
+
+static bool
+hashindex_build (Array a)
+{
+  int i, capacity = HASHINDEX_MINSLOTS;
+  Hashindex hi = a->hashindex;
+  struct Hashslot empty = { 0, HASHINDEX_EMPTY };
+
+  while (capacity < HASHINDEX_MAXSLOTS && capacity / 2 < array_length (a))
+    capacity *= 2;
+
+  if (!array_resize (hi->slots, capacity) || !array_set (hi->slots, &empty)
+      || !array_resize (hi->next, array_length (a))
+      || !array_resize (hi->prev, array_length (a)))
+    return false;
+  hi->used = 0;
+  hi->tombstones = 0;
+
+  for (i = 0; i < array_length (a); i++)
+    if (!hashindex_link (a, i))
+      return false;
+
+  return true;
+}
+
+bool
+array_attachindex (Array a)
+{
+  Hashindex hi;
+
+  if (array_null (a))
+    return false;
+  if (!element_null (a->hashindex))
+    return true;
+
+  hi = malloc (sizeof (struct Hashindex));
+  if (element_null (hi))
+    return false;
+
+  hi->slots = array_new (HASHINDEX_MINSLOTS, sizeof (struct Hashslot));
+  hi->next = array_new (0, sizeof (int));
+  hi->prev = array_new (0, sizeof (int));
+  a->hashindex = hi;
+  if (array_null (hi->slots) || array_null (hi->next)
+      || array_null (hi->prev) || !hashindex_build (a))
+    {
+      array_detachindex (a);
+      return false;
+    }
+
+  return true;
+}
+
+void
+array_detachindex (Array a)
+{
+  if (array_null (a) || element_null (a->hashindex))
+    return;
+
+  array_delete (&a->hashindex->slots);
+  array_delete (&a->hashindex->next);
+  array_delete (&a->hashindex->prev);
+  free (a->hashindex);
+  a->hashindex = NULL;
+}
+
+int
+array_find (Array a, void *element)
+{
+  int i, slot;
+
+  if (array_null (a) || element_null (element))
+    return -1;
+
+  if (!element_null (a->hashindex))
+    {
+      slot = hashindex_lookup (a, element,
+			       hashindex_hash (element, array_size (a)));
+      return (slot < 0 ? -1 : hashindex_slots (a->hashindex)[slot].head);
+    }
+
+  for (i = 0; i < array_length (a); i++)
+    if (memcmp (array_pointer (a) + ((size_t) i) * array_size (a), element,
+		array_size (a)) == 0)
+      return i;
+
+  return -1;
+}
+
+/*
+ *********************************************
+ * Concurrent append array specific methods. *
+ *********************************************
+ */
+static int
+concarray_chunkindex (int index)
+{
+  unsigned int pos = (unsigned int) index + CONCARRAY_FIRST;
+
+  /*
+   * Chunk k starts at index (CONCARRAY_FIRST << k) - CONCARRAY_FIRST, so the
+   * chunk number is the position of the highest bit set, shifted by the
+   * size of the first chunk.
+   */
+  return (((int) (sizeof (unsigned int) * CHAR_BIT) - 1 - __builtin_clz (pos))
+	  - __builtin_ctz (CONCARRAY_FIRST));
+}
+
+static size_t
+concarray_chunkoffset (int index, int k)
+{
+  return (((size_t) index + CONCARRAY_FIRST) - concarray_chunklength (k));
+}
+
+static size_t
+concarray_chunklength (int k)
+{
+  return (((size_t) CONCARRAY_FIRST) << k);
+}
+
+/**
+ * @note If two producers race to allocate the same chunk, the loser frees
+ * its own copy and uses the one installed by the winner.
+ */
+static char *
+concarray_chunkalloc (Concarray ca, int k)
+{
+  char *chunk, *expected = NULL;
+
+  chunk = __atomic_load_n (&ca->chunk[k], __ATOMIC_ACQUIRE);
+  if (!element_null (chunk))
+    return chunk;
+
+  /*
+   * One extra byte per element for the ready flags, which must start
+   * cleared.
+   */
+  chunk = calloc (concarray_chunklength (k), ca->size + 1);
+  if (element_null (chunk))
+    return NULL;
+
+  if (!__atomic_compare_exchange_n (&ca->chunk[k], &expected, chunk, false,
+				    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+      free (chunk);
+      chunk = expected;
+    }
+
+  return chunk;
+}
+
+Concarray
+concarray_new (size_t size)
+{
+  int k;
+  Concarray new_concarray = NULL;
+
+  if (size > 0)
+    {
+      new_concarray = malloc (sizeof (struct Concarray));
+      if (element_null (new_concarray))
+	return NULL;
+
+      new_concarray->size = size;
+      new_concarray->counts = 0;
+      for (k = 0; k < CONCARRAY_CHUNKS; k++)
+	new_concarray->chunk[k] = NULL;
+    }
+
+  return new_concarray;
+}
+
+void
+concarray_delete (Concarray * ca_ref)
+{
+  int k;
+
+  if (!element_null (ca_ref) && !element_null (*ca_ref))
+    {
+      for (k = 0; k < CONCARRAY_CHUNKS; k++)
+	free ((*ca_ref)->chunk[k]);
+      free (*ca_ref);
+      *ca_ref = NULL;
+    }
+}
+
+int
+concarray_length (Concarray ca)
+{
+  assert (!element_null (ca));
+  return ((int) (__atomic_load_n (&ca->counts, __ATOMIC_RELAXED)
+		 & CONCARRAY_SLOTS));
+}
+
+/**
+ * @note The element is published by setting its ready flag with release
+ * semantics, after it has been copied.
+ */
+bool
+concarray_append (Concarray ca, void *element)
+{
+  int index, k;
+  uint64_t counts;
+  size_t offset;
+  char *chunk;
+
+  if (element_null (ca) || element_null (element))
+    return false;
+
+  /*
+   * A compare and swap instead of a fetch-add, so that the number of slots
+   * stops at INT_MAX instead of wrapping around.
+   */
+  counts = __atomic_load_n (&ca->counts, __ATOMIC_RELAXED);
+  do
+    if ((counts & CONCARRAY_SLOTS) == INT_MAX)
+      return false;
+  while (!__atomic_compare_exchange_n (&ca->counts, &counts, counts + 1,
+				       true, __ATOMIC_RELAXED,
+				       __ATOMIC_RELAXED));
+  index = (int) (counts & CONCARRAY_SLOTS);
+
+  k = concarray_chunkindex (index);
+  offset = concarray_chunkoffset (index, k);
+  chunk = concarray_chunkalloc (ca, k);
+  if (element_null (chunk))
+    {
+      __atomic_fetch_add (&ca->counts, CONCARRAY_SLOTS + 1,
+			  __ATOMIC_RELEASE);
+      return false;
+    }
+
+  memcpy (chunk + offset * ca->size, element, ca->size);
+  __atomic_store_n (chunk + concarray_chunklength (k) * ca->size + offset, 1,
+		    __ATOMIC_RELEASE);
+
+  return true;
+}
+
+char *
+concarray_get (Concarray ca, int index)
+{
+  int k;
+  size_t offset;
+  char *chunk;
+
+  if (element_null (ca) || index < 0 || index >= concarray_length (ca))
+    return NULL;
+
+  k = concarray_chunkindex (index);
+  offset = concarray_chunkoffset (index, k);
+  chunk = __atomic_load_n (&ca->chunk[k], __ATOMIC_ACQUIRE);
+  if (element_null (chunk)
+      || !__atomic_load_n (chunk + concarray_chunklength (k) * ca->size +
+			   offset, __ATOMIC_ACQUIRE))
+    return NULL;
+
+  return (chunk + offset * ca->size);
+}
+
+/**
+ * @note Every chunk is copied with a single memcpy, once all of its ready
+ * flags have been checked.
+ */
+Array
+concarray_to_array (Concarray ca)
+{
+  int k, length, nfailed;
+  uint64_t counts;
+  size_t i, count, seen = 0, copied = 0;
+  char *chunk, *flags;
+  Array a;
+
+  if (element_null (ca))
+    return NULL;
+
+  counts = __atomic_load_n (&ca->counts, __ATOMIC_ACQUIRE);
+  length = (int) (counts & CONCARRAY_SLOTS);
+  nfailed = (int) (counts >> 32);
+  a = array_new (length - nfailed, ca->size);
+  if (array_null (a))
+    return NULL;
+
+  for (k = 0; seen < (size_t) length; k++)
+    {
+      count = concarray_chunklength (k);
+      if (count > (size_t) length - seen)
+	count = (size_t) length - seen;
+      seen += count;
+
+      /*
+       * A missing chunk only holds failed slots, which are checked against
+       * the failed slots at the end.
+       */
+      chunk = __atomic_load_n (&ca->chunk[k], __ATOMIC_ACQUIRE);
+      if (element_null (chunk))
+	continue;
+
+      flags = chunk + concarray_chunklength (k) * ca->size;
+      for (i = 0; i < count; i++)
+	if (__atomic_load_n (flags + i, __ATOMIC_ACQUIRE))
+	  {
+	    if (copied == (size_t) array_length (a))
+	      {
+		array_delete (&a);
+		return NULL;
+	      }
+	    memcpy (array_pointer (a) + copied * ca->size,
+		    chunk + i * ca->size, ca->size);
+	    copied++;
+	  }
+    }
+
+  if (copied != (size_t) array_length (a))
+    array_delete (&a);
+
+  return a;
+}
+
+/*
+ **************************************
+ * Columnar record container methods. *
+ **************************************
+ */
+Colarray
+colarray_new (int nmemb, int ncolumns, size_t * sizes, size_t * offsets)
+{
+  int i;
+  size_t offset = 0;
+  Colarray new_colarray;
+
+  if (ncolumns <= 0 || element_null (sizes))
+    return NULL;
+
+  new_colarray = malloc (sizeof (struct Colarray));
+  if (element_null (new_colarray))
+    return NULL;
+
+  new_colarray->ncolumns = ncolumns;
+  new_colarray->offset = malloc (((size_t) ncolumns) * sizeof (size_t));
+  new_colarray->column = calloc (ncolumns, sizeof (Array));
+  if (element_null (new_colarray->offset)
+      || element_null (new_colarray->column))
+    {
+      colarray_delete (&new_colarray);
+      return NULL;
+    }
+
+  for (i = 0; i < ncolumns; i++)
+    {
+      new_colarray->offset[i] = element_null (offsets) ? offset : offsets[i];
+      offset += sizes[i];
+      new_colarray->column[i] = array_new (nmemb, sizes[i]);
+      if (array_null (new_colarray->column[i]))
+	{
+	  colarray_delete (&new_colarray);
+	  return NULL;
+	}
+    }
+
+  return new_colarray;
+}
+
+void
+colarray_delete (Colarray * ca_ref)
+{
+  int i;
+
+  if (!element_null (ca_ref) && !element_null (*ca_ref))
+    {
+      if (!element_null ((*ca_ref)->column))
+	for (i = 0; i < (*ca_ref)->ncolumns; i++)
+	  array_delete (&(*ca_ref)->column[i]);
+      free ((*ca_ref)->column);
+      free ((*ca_ref)->offset);
+      free (*ca_ref);
+      *ca_ref = NULL;
+    }
+}
+
+int
+colarray_length (Colarray ca)
+{
+  assert (!element_null (ca));
+  return (array_length (ca->column[0]));
+}
+
+Array
+colarray_column (Colarray ca, int column)
+{
+  if (element_null (ca) || column < 0 || column >= ca->ncolumns)
+    return NULL;
+
+  return (ca->column[column]);
+}
+
+bool
+colarray_put (Colarray ca, int index, void *record)
+{
+  int i;
+
+  if (element_null (ca) || element_null (record)
+      || array_indexoutofbounds (ca->column[0], index))
+    return false;
+
+  for (i = 0; i < ca->ncolumns; i++)
+    if (!array_memcopy (ca->column[i], index, (char *) record + ca->offset[i]))
+      return false;
+
+  return true;
+}
+
+bool
+colarray_get (Colarray ca, int index, void *record)
+{
+  int i;
+
+  if (element_null (ca) || element_null (record)
+      || array_indexoutofbounds (ca->column[0], index))
+    return false;
+
+  for (i = 0; i < ca->ncolumns; i++)
+    memcpy ((char *) record + ca->offset[i],
+	    array_indexpointer (ca->column[i], index),
+	    array_size (ca->column[i]));
+
+  return true;
+}
+
+/**
+ * @note Shrinking cannot fail, so only a grow can leave the columns with
+ * different lengths: in that case, the columns that were already grown are
+ * truncated back to the old length.
+ */
+bool
+colarray_resize (Colarray ca, int new_length)
+{
+  int i, initial_length;
+
+  if (element_null (ca) || new_length < 0)
+    return false;
+
+  initial_length = colarray_length (ca);
+  if (new_length < initial_length)
+    {
+      for (i = 0; i < ca->ncolumns; i++)
+	array_truncate (ca->column[i], new_length);
+      return true;
+    }
+
+  for (i = 0; i < ca->ncolumns; i++)
+    if (!array_resize (ca->column[i], new_length))
+      {
+	while (i-- > 0)
+	  array_truncate (ca->column[i], initial_length);
+	return false;
+      }
+
+  return true;
+}
+
+bool
+colarray_append (Colarray ca, void *record)
+{
+  int initial_length;
+
+  if (element_null (ca) || element_null (record))
+    return false;
+
+  initial_length = colarray_length (ca);
+  if (colarray_resize (ca, initial_length + 1)
+      && colarray_put (ca, initial_length, record))
+    return true;
+  else
+    return false;
+}
+
+/**
+ * @note Once the index is checked, erasing from a column cannot fail, so the
+ * columns keep the same length.
+ */
+bool
+colarray_erase (Colarray ca, int index)
+{
+  int i;
+
+  if (element_null (ca) || array_indexoutofbounds (ca->column[0], index))
+    return false;
+
+  for (i = 0; i < ca->ncolumns; i++)
+    array_erase (ca->column[i], index);
+
+  return true;
+}
+
+/*
+ *******************************
+ * Bit array specific methods. *
+ *******************************
+ */
+static uint64_t *
+bitarray_words (Bitarray b)
+{
+  return ((uint64_t *) array_pointer (b->words));
+}
+
+static int
+bitarray_nwords (Bitarray b)
+{
+  return (array_length (b->words));
+}
+
+static bool
+bitarray_compatible (Bitarray b1, Bitarray b2)
+{
+  return (!element_null (b1) && !element_null (b2)
+	  && bitarray_length (b1) == bitarray_length (b2));
+}
+
+Bitarray
+bitarray_new (int nbits)
+{
+  Bitarray new_bitarray;
+
+  if (nbits < 0)
+    return NULL;
+
+  new_bitarray = malloc (sizeof (struct Bitarray));
+  if (element_null (new_bitarray))
+    return NULL;
+
+  new_bitarray->nbits = nbits;
+  new_bitarray->words =
+    array_new (nbits / BITARRAY_WORDBITS + (nbits % BITARRAY_WORDBITS != 0),
+	       sizeof (uint64_t));
+  new_bitarray->ranks =
+    array_new (array_null (new_bitarray->words) ? 0 :
+	       array_length (new_bitarray->words) / BITARRAY_SUPERWORDS + 1,
+	       sizeof (int));
+  new_bitarray->ranked = true;
+  if (array_null (new_bitarray->words) || array_null (new_bitarray->ranks))
+    bitarray_delete (&new_bitarray);
+
+  return new_bitarray;
+}
+
+void
+bitarray_delete (Bitarray * b_ref)
+{
+  if (!element_null (b_ref) && !element_null (*b_ref))
+    {
+      array_delete (&(*b_ref)->words);
+      array_delete (&(*b_ref)->ranks);
+      free (*b_ref);
+      *b_ref = NULL;
+    }
+}
+
+int
+bitarray_length (Bitarray b)
+{
+  assert (!element_null (b));
+  return (b->nbits);
+}
+
+bool
+bitarray_set (Bitarray b, int index)
+{
+  if (element_null (b) || index < 0 || index >= bitarray_length (b))
+    return false;
+
+  bitarray_words (b)[index / BITARRAY_WORDBITS] |=
+    UINT64_C (1) << (index % BITARRAY_WORDBITS);
+  b->ranked = false;
+  return true;
+}
+
+bool
+bitarray_clear (Bitarray b, int index)
+{
+  if (element_null (b) || index < 0 || index >= bitarray_length (b))
+    return false;
+
+  bitarray_words (b)[index / BITARRAY_WORDBITS] &=
+    ~(UINT64_C (1) << (index % BITARRAY_WORDBITS));
+  b->ranked = false;
+  return true;
+}
+
+bool
+bitarray_test (Bitarray b, int index)
+{
+  if (element_null (b) || index < 0 || index >= bitarray_length (b))
+    return false;
+
+  return ((bitarray_words (b)[index / BITARRAY_WORDBITS]
+	   >> (index % BITARRAY_WORDBITS)) & 1);
+}
+
+static void
+bitarray_rankall (Bitarray b)
+{
+  int s, i, rank = 0;
+  uint64_t *w = bitarray_words (b);
+  int *ranks = (int *) array_pointer (b->ranks);
+
+  if (b->ranked)
+    return;
+
+  for (s = 0, i = 0; s < array_length (b->ranks); s++)
+    {
+      ranks[s] = rank;
+      for (; i < bitarray_nwords (b) && i < (s + 1) * BITARRAY_SUPERWORDS; i++)
+	rank += __builtin_popcountll (w[i]);
+    }
+  b->ranked = true;
+}
+
+static bool
+bitarray_combine (Bitarray b1, Bitarray b2, int op)
+{
+  if (!bitarray_compatible (b1, b2))
+    return false;
+
+  switch (array_simd ())
+    {
+#if defined (SALIBC_X86)
+    case ARRAY_AVX2:
+      bitarray_combineavx2 (bitarray_words (b1), bitarray_words (b2),
+			    bitarray_nwords (b1), op);
+      break;
+    case ARRAY_SSE2:
+      bitarray_combinesse2 (bitarray_words (b1), bitarray_words (b2),
+			    bitarray_nwords (b1), op);
+      break;
+#endif
+    default:
+      bitarray_combinescalar (bitarray_words (b1), bitarray_words (b2),
+			      bitarray_nwords (b1), op);
+      break;
+    }
+  b1->ranked = false;
+
+  return true;
+}
+
+static void
+bitarray_combinescalar (uint64_t *w1, const uint64_t *w2, int n, int op)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    switch (op)
+      {
+      case BITARRAY_AND:
+	w1[i] &= w2[i];
+	break;
+      case BITARRAY_OR:
+	w1[i] |= w2[i];
+	break;
+      case BITARRAY_XOR:
+	w1[i] ^= w2[i];
+	break;
+      default:
+	w1[i] &= ~w2[i];
+	break;
+      }
+}
+
+#if defined (SALIBC_X86) || DOXYGEN
+
+/**
+ * @note The operation is chosen once, outside of the word loop.
+ */
+static void
+bitarray_combinesse2 (uint64_t *w1, const uint64_t *w2, int n, int op)
+{
+  int i;
+  __m128i x, y;
+
+  for (i = 0; i + 2 <= n; i += 2)
+    {
+      x = _mm_loadu_si128 ((const __m128i *) (w1 + i));
+      y = _mm_loadu_si128 ((const __m128i *) (w2 + i));
+      if (op == BITARRAY_AND)
+	x = _mm_and_si128 (x, y);
+      else if (op == BITARRAY_OR)
+	x = _mm_or_si128 (x, y);
+      else if (op == BITARRAY_XOR)
+	x = _mm_xor_si128 (x, y);
+      else
+	x = _mm_andnot_si128 (y, x);
+      _mm_storeu_si128 ((__m128i *) (w1 + i), x);
+    }
+
+  bitarray_combinescalar (w1 + i, w2 + i, n - i, op);
+}
+
+static void
+bitarray_combineavx2 (uint64_t *w1, const uint64_t *w2, int n, int op)
+{
+  int i;
+  __m256i x, y;
+
+  for (i = 0; i + 4 <= n; i += 4)
+    {
+      x = _mm256_loadu_si256 ((const __m256i *) (w1 + i));
+      y = _mm256_loadu_si256 ((const __m256i *) (w2 + i));
+      if (op == BITARRAY_AND)
+	x = _mm256_and_si256 (x, y);
+      else if (op == BITARRAY_OR)
+	x = _mm256_or_si256 (x, y);
+      else if (op == BITARRAY_XOR)
+	x = _mm256_xor_si256 (x, y);
+      else
+	x = _mm256_andnot_si256 (y, x);
+      _mm256_storeu_si256 ((__m256i *) (w1 + i), x);
+    }
+
+  bitarray_combinescalar (w1 + i, w2 + i, n - i, op);
+}
+#endif
+
+bool
+bitarray_and (Bitarray b1, Bitarray b2)
+{
+  return (bitarray_combine (b1, b2, BITARRAY_AND));
+}
+
+bool
+bitarray_or (Bitarray b1, Bitarray b2)
+{
+  return (bitarray_combine (b1, b2, BITARRAY_OR));
+}
+
+bool
+bitarray_xor (Bitarray b1, Bitarray b2)
+{
+  return (bitarray_combine (b1, b2, BITARRAY_XOR));
+}
+
+bool
+bitarray_andnot (Bitarray b1, Bitarray b2)
+{
+  return (bitarray_combine (b1, b2, BITARRAY_ANDNOT));
+}
+
+int
+bitarray_count (Bitarray b)
+{
+  return (bitarray_rank (b, bitarray_length (b)));
+}
+
+/**
+ * @note __builtin_popcountll becomes a single instruction when the target
+ * supports it.
+ */
+int
+bitarray_rank (Bitarray b, int index)
+{
+  int i, rank;
+  uint64_t *w;
+
+  assert (!element_null (b));
+  if (index < 0 || index > bitarray_length (b))
+    return -1;
+
+  bitarray_rankall (b);
+  w = bitarray_words (b);
+  i = index / BITARRAY_WORDBITS / BITARRAY_SUPERWORDS;
+  rank = ((int *) array_pointer (b->ranks))[i];
+  for (i *= BITARRAY_SUPERWORDS; i < index / BITARRAY_WORDBITS; i++)
+    rank += __builtin_popcountll (w[i]);
+  if (index % BITARRAY_WORDBITS != 0)
+    rank += __builtin_popcountll (w[i] & ((UINT64_C (1) <<
+					   (index % BITARRAY_WORDBITS)) - 1));
+
+  return rank;
+}
+
+/**
+ * @note Whole words are skipped while they are zero, then the lowest bit set
+ * is found with __builtin_ctzll.
+ */
+int
+bitarray_next (Bitarray b, int index)
+{
+  int i;
+  uint64_t word, *w;
+
+  assert (!element_null (b));
+  if (index < 0)
+    index = 0;
+  if (index >= bitarray_length (b))
+    return -1;
+
+  w = bitarray_words (b);
+  i = index / BITARRAY_WORDBITS;
+  word = w[i] & (~UINT64_C (0) << (index % BITARRAY_WORDBITS));
+  while (word == 0)
+    {
+      if (++i == bitarray_nwords (b))
+	return -1;
+      word = w[i];
+    }
+
+  return (i * BITARRAY_WORDBITS + __builtin_ctzll (word));
+}
+
+Bitarray
+bitarray_from_array (Array a)
+{
+  int i;
+  Bitarray b;
+
+  if (array_null (a) || array_size (a) != sizeof (bool))
+    return NULL;
+
+  b = bitarray_new (array_length (a));
+  if (element_null (b))
+    return NULL;
+
+  for (i = 0; i < array_length (a); i++)
+    if (*((bool *) array_indexpointer (a, i)))
+      bitarray_set (b, i);
+
+  return b;
+}
+
+Array
+bitarray_to_array (Bitarray b)
+{
+  int i;
+  Array a;
+
+  if (element_null (b))
+    return NULL;
+
+  a = array_new (bitarray_length (b), sizeof (bool));
+  if (array_null (a))
+    return NULL;
+
+  for (i = bitarray_next (b, 0); i >= 0; i = bitarray_next (b, i + 1))
+    *((bool *) array_indexpointer (a, i)) = true;
+
+  return a;
+}
+
+/*
+ **********************************************
+ * Compressed integer array specific methods. *
+ **********************************************
+ */
+static uint64_t
+cintarray_load (void *element, size_t size)
+{
+  uint32_t value32;
+  uint64_t value64;
+
+  if (size == sizeof (uint32_t))
+    {
+      memcpy (&value32, element, sizeof (uint32_t));
+      return value32;
+    }
+
+  memcpy (&value64, element, sizeof (uint64_t));
+  return value64;
+}
+
+static void
+cintarray_store (void *element, size_t size, uint64_t value)
+{
+  uint32_t value32 = (uint32_t) value;
+
+  if (size == sizeof (uint32_t))
+    memcpy (element, &value32, sizeof (uint32_t));
+  else
+    memcpy (element, &value, sizeof (uint64_t));
+}
+
+static size_t
+cintarray_packedsize (int width)
+{
+  return ((((size_t) (CINTARRAY_BLOCK - 1) * width + 63) / 64 + 1)
+	  * sizeof (uint64_t));
+}
+
+/**
+ * @note A block is made of its first element (8 bytes), the bit width and
+ * the number of exceptions (1 byte each), the packed differences and the
+ * exceptions. One extra word is added to the packed differences so that the
+ * decoder can always load 64 bits at a time. Each exception takes its
+ * position (1 byte) and its whole zigzag encoded difference (8 bytes).
+ */
+static size_t
+cintarray_blocksize (int width, int nexceptions)
+{
+  return (sizeof (uint64_t) + 2 + cintarray_packedsize (width)
+	  + ((size_t) nexceptions) * (1 + sizeof (uint64_t)));
+}
+
+static bool
+cintarray_encode (Cintarray ca)
+{
+  int i, j, width, nexceptions = 0, lengths[65] = { 0 }, pos;
+  uint64_t zigzag[CINTARRAY_BLOCK], delta, mask, word;
+  size_t offset = (size_t) array_length (ca->data), bit, size;
+  unsigned char header[2], position;
+  char *block, *exceptions;
+
+  /*
+   * Differences are zigzag encoded, so that small negative values also
+   * need only a few bits. 4 byte differences are taken modulo 2^32 and sign
+   * extended, so that a series that wraps around, e.g. a signed one
+   * crossing zero, still gets small differences.
+   */
+  for (i = 1; i < CINTARRAY_BLOCK; i++)
+    {
+      delta = ca->pending[i] - ca->pending[i - 1];
+      if (ca->size == sizeof (uint32_t))
+	{
+	  delta &= UINT32_MAX;
+	  if (delta >> 31)
+	    delta |= ~(uint64_t) UINT32_MAX;
+	}
+      zigzag[i] = (delta << 1) ^ (0 - (delta >> 63));
+      lengths[zigzag[i] == 0 ? 0 : 64 - __builtin_clzll (zigzag[i])]++;
+    }
+
+  /*
+   * Start from the width of the largest difference, then try narrower
+   * ones: each step turns the differences that no longer fit into
+   * exceptions. The smallest block wins, so a few outliers do not widen all
+   * the other differences.
+   */
+  for (width = 64; width > 0 && lengths[width] == 0; width--)
+    ;
+  for (i = width, j = 0;
+       i > 0 && j + lengths[i] <= CINTARRAY_EXCEPTIONS; i--)
+    {
+      j += lengths[i];
+      if (cintarray_blocksize (i - 1, j)
+	  < cintarray_blocksize (width, nexceptions))
+	{
+	  width = i - 1;
+	  nexceptions = j;
+	}
+    }
+
+  size = cintarray_blocksize (width, nexceptions);
+  if (offset > (size_t) INT_MAX - size)
+    return false;
+  if (!array_resize (ca->data, (int) (offset + size)))
+    return false;
+  if (!array_append (ca->blocks, &offset))
+    {
+      array_resize (ca->data, (int) offset);
+      return false;
+    }
+
+  block = array_pointer (ca->data) + offset;
+  memset (block, 0, size);
+  memcpy (block, &ca->pending[0], sizeof (uint64_t));
+  header[0] = (unsigned char) width;
+  header[1] = (unsigned char) nexceptions;
+  memcpy (block + sizeof (uint64_t), header, 2);
+  block += sizeof (uint64_t) + 2;
+  exceptions = block + cintarray_packedsize (width);
+  mask = width == 64 ? ~UINT64_C (0) : (UINT64_C (1) << width) - 1;
+
+  for (i = 1, j = 0; i < CINTARRAY_BLOCK; i++)
+    if ((zigzag[i] & ~mask) != 0)
+      {
+	position = (unsigned char) i;
+	memcpy (exceptions + j, &position, 1);
+	memcpy (exceptions + nexceptions + ((size_t) j) * sizeof (uint64_t),
+		&zigzag[i], sizeof (uint64_t));
+	j++;
+      }
+
+  for (i = 1, bit = 0; width > 0 && i < CINTARRAY_BLOCK; i++, bit += width)
+    {
+      pos = (int) (bit % 64);
+      memcpy (&word, block + bit / 64 * sizeof (uint64_t), sizeof (uint64_t));
+      word |= (zigzag[i] & mask) << pos;
+      memcpy (block + bit / 64 * sizeof (uint64_t), &word, sizeof (uint64_t));
+      if (pos + width > 64)
+	{
+	  memcpy (&word, block + (bit / 64 + 1) * sizeof (uint64_t),
+		  sizeof (uint64_t));
+	  word |= (zigzag[i] & mask) >> (64 - pos);
+	  memcpy (block + (bit / 64 + 1) * sizeof (uint64_t), &word,
+		  sizeof (uint64_t));
+	}
+    }
+
+  ca->npending = 0;
+  return true;
+}
+
+/**
+ * @note The differences are unpacked in place, patched with the exceptions,
+ * then the running sum rebuilds the elements.
+ */
+static void
+cintarray_decode (Cintarray ca, int block, uint64_t * values, int count)
+{
+  int i, width, nexceptions;
+  uint64_t value;
+  unsigned char header[2], position;
+  char *packed, *exceptions;
+
+  packed = array_pointer (ca->data)
+    + *((size_t *) array_indexpointer (ca->blocks, block));
+  memcpy (&value, packed, sizeof (uint64_t));
+  memcpy (header, packed + sizeof (uint64_t), 2);
+  width = header[0];
+  nexceptions = header[1];
+  packed += sizeof (uint64_t) + 2;
+  exceptions = packed + cintarray_packedsize (width);
+
+  cintarray_unpack (packed, width, values + 1, count - 1);
+  for (i = 0; i < nexceptions; i++)
+    {
+      memcpy (&position, exceptions + i, 1);
+      if (position < count)
+	memcpy (&values[position],
+		exceptions + nexceptions + ((size_t) i) * sizeof (uint64_t),
+		sizeof (uint64_t));
+    }
+
+  values[0] = value;
+  for (i = 1; i < count; i++)
+    {
+      value += (values[i] >> 1) ^ (0 - (values[i] & 1));
+      if (ca->size == sizeof (uint32_t))
+	value &= UINT32_MAX;
+      values[i] = value;
+    }
+}
+
+static void
+cintarray_unpack (const char *packed, int width, uint64_t * values, int n)
+{
+  switch (array_simd ())
+    {
+#if defined (SALIBC_X86)
+    case ARRAY_AVX2:
+      cintarray_unpackavx2 (packed, width, values, n);
+      break;
+    case ARRAY_SSE2:
+      cintarray_unpacksse2 (packed, width, values, n);
+      break;
+#endif
+    default:
+      cintarray_unpackscalar (packed, width, values, 0, n);
+      break;
+    }
+}
+
+/**
+ * @note Each value is read with at most two 64 bit loads.
+ */
+static void
+cintarray_unpackscalar (const char *packed, int width, uint64_t * values,
+			int first, int n)
+{
+  int i, pos;
+  uint64_t lo, hi, mask;
+  size_t bit;
+
+  mask = width == 64 ? ~UINT64_C (0) : (UINT64_C (1) << width) - 1;
+  for (i = first; i < n; i++)
+    {
+      values[i] = 0;
+      if (width == 0)
+	continue;
+      bit = ((size_t) i) * width;
+      pos = (int) (bit % 64);
+      memcpy (&lo, packed + bit / 64 * sizeof (uint64_t), sizeof (uint64_t));
+      values[i] = lo >> pos;
+      if (pos + width > 64)
+	{
+	  memcpy (&hi, packed + (bit / 64 + 1) * sizeof (uint64_t),
+		  sizeof (uint64_t));
+	  values[i] |= hi << (64 - pos);
+	}
+      values[i] &= mask;
+    }
+}
+
+#if defined (SALIBC_X86)
+static void
+cintarray_unpacksse2 (const char *packed, int width, uint64_t * values, int n)
+{
+  int i = 0;
+  size_t bit;
+  __m128i lo, hi, mask;
+
+  if (width <= 56)
+    {
+      mask = _mm_set1_epi64x ((long long) ((UINT64_C (1) << width) - 1));
+      for (; i + 2 <= n; i += 2)
+	{
+	  bit = ((size_t) i) * width;
+	  lo = _mm_loadl_epi64 ((const __m128i *) (packed + bit / 8));
+	  lo = _mm_srl_epi64 (lo, _mm_cvtsi32_si128 ((int) (bit % 8)));
+	  bit += width;
+	  hi = _mm_loadl_epi64 ((const __m128i *) (packed + bit / 8));
+	  hi = _mm_srl_epi64 (hi, _mm_cvtsi32_si128 ((int) (bit % 8)));
+	  _mm_storeu_si128 ((__m128i *) (values + i),
+			    _mm_and_si128 (_mm_unpacklo_epi64 (lo, hi),
+					   mask));
+	}
+    }
+
+  cintarray_unpackscalar (packed, width, values, i, n);
+}
+
+static void
+cintarray_unpackavx2 (const char *packed, int width, uint64_t * values, int n)
+{
+  int i = 0;
+  __m256i bits, step, mask, seven, words;
+
+  if (width <= 56)
+    {
+      mask = _mm256_set1_epi64x ((long long) ((UINT64_C (1) << width) - 1));
+      bits = _mm256_set_epi64x (3 * width, 2 * width, width, 0);
+      step = _mm256_set1_epi64x (4 * width);
+      seven = _mm256_set1_epi64x (7);
+      for (; i + 4 <= n; i += 4)
+	{
+	  words = _mm256_i64gather_epi64 ((const long long *) packed,
+					  _mm256_srli_epi64 (bits, 3), 1);
+	  words = _mm256_srlv_epi64 (words, _mm256_and_si256 (bits, seven));
+	  _mm256_storeu_si256 ((__m256i *) (values + i),
+			       _mm256_and_si256 (words, mask));
+	  bits = _mm256_add_epi64 (bits, step);
+	}
+    }
+
+  cintarray_unpackscalar (packed, width, values, i, n);
+}
+#endif
+
+Cintarray
+cintarray_new (size_t size)
+{
+  Cintarray new_cintarray;
+
+  if (size != sizeof (uint32_t) && size != sizeof (uint64_t))
+    return NULL;
+
+  new_cintarray = malloc (sizeof (struct Cintarray));
+  if (element_null (new_cintarray))
+    return NULL;
+
+  new_cintarray->size = size;
+  new_cintarray->nmemb = 0;
+  new_cintarray->npending = 0;
+  new_cintarray->blocks = array_new (0, sizeof (size_t));
+  new_cintarray->data = array_new (0, sizeof (char));
+  if (array_null (new_cintarray->blocks) || array_null (new_cintarray->data))
+    cintarray_delete (&new_cintarray);
+
+  return new_cintarray;
+}
+
+void
+cintarray_delete (Cintarray * ca_ref)
+{
+  if (!element_null (ca_ref) && !element_null (*ca_ref))
+    {
+      array_delete (&(*ca_ref)->blocks);
+      array_delete (&(*ca_ref)->data);
+      free (*ca_ref);
+      *ca_ref = NULL;
+    }
 }
 
 int
-array_length (Array a)
+cintarray_length (Cintarray ca)
 {
-  assert (!array_null (a));
-  return (a->nmemb);
+  assert (!element_null (ca));
+  return (ca->nmemb);
+}
+
+size_t
+cintarray_fullsize (Cintarray ca)
+{
+  assert (!element_null (ca));
+  return (array_fullsize (ca->data) + array_fullsize (ca->blocks)
+	  + ((size_t) ca->npending) * ca->size);
+}
+
+bool
+cintarray_append (Cintarray ca, void *element)
+{
+  if (element_null (ca) || element_null (element) || ca->nmemb == INT_MAX)
+    return false;
+
+  ca->pending[ca->npending] = cintarray_load (element, ca->size);
+  ca->npending++;
+  if (ca->npending == CINTARRAY_BLOCK && !cintarray_encode (ca))
+    {
+      ca->npending--;
+      return false;
+    }
+
+  ca->nmemb++;
+  return true;
+}
+
+bool
+cintarray_get (Cintarray ca, int index, void *element)
+{
+  uint64_t values[CINTARRAY_BLOCK];
+  int encoded;
+
+  if (element_null (ca) || element_null (element) || index < 0
+      || index >= cintarray_length (ca))
+    return false;
+
+  encoded = cintarray_length (ca) - ca->npending;
+  if (index >= encoded)
+    cintarray_store (element, ca->size, ca->pending[index - encoded]);
+  else
+    {
+      cintarray_decode (ca, index / CINTARRAY_BLOCK, values,
+			index % CINTARRAY_BLOCK + 1);
+      cintarray_store (element, ca->size, values[index % CINTARRAY_BLOCK]);
+    }
+
+  return true;
+}
+
+Cintarray
+cintarray_from_array (Array a)
+{
+  int i;
+  Cintarray ca;
+
+  if (array_null (a))
+    return NULL;
+
+  ca = cintarray_new (array_size (a));
+  if (element_null (ca))
+    return NULL;
+
+  for (i = 0; i < array_length (a); i++)
+    if (!cintarray_append (ca, array_indexpointer (a, i)))
+      {
+	cintarray_delete (&ca);
+	return NULL;
+      }
+
+  return ca;
+}
+
+Array
+cintarray_to_array (Cintarray ca)
+{
+  int i, j, encoded;
+  uint64_t values[CINTARRAY_BLOCK];
+  Array a;
+
+  if (element_null (ca))
+    return NULL;
+
+  a = array_new (cintarray_length (ca), ca->size);
+  if (array_null (a))
+    return NULL;
+
+  /*
+   * 8 byte elements are decoded in place, 4 byte ones go through a buffer.
+   */
+  encoded = cintarray_length (ca) - ca->npending;
+  for (i = 0; i < encoded; i += CINTARRAY_BLOCK)
+    if (ca->size == sizeof (uint64_t))
+      cintarray_decode (ca, i / CINTARRAY_BLOCK,
+			(uint64_t *) array_indexpointer (a, i),
+			CINTARRAY_BLOCK);
+    else
+      {
+	cintarray_decode (ca, i / CINTARRAY_BLOCK, values, CINTARRAY_BLOCK);
+	for (j = 0; j < CINTARRAY_BLOCK; j++)
+	  ((uint32_t *) array_indexpointer (a, i))[j] = (uint32_t) values[j];
+      }
+  for (j = 0; j < ca->npending; j++)
+    cintarray_store (array_indexpointer (a, encoded + j), ca->size,
+		     ca->pending[j]);
+
+  return a;
+}
+
+/*
+ ********************
+ * Numeric kernels. *
+ ********************
+ */
+static bool
+array_typecheck (Array a, Arraytype type)
+{
+  static const size_t sizes[] = { sizeof (int32_t), sizeof (int64_t),
+    sizeof (float), sizeof (double)
+  };
+
+  return (!array_null (a) && (int) type >= 0 && type <= ARRAY_DOUBLE
+	  && array_size (a) == sizes[type]);
+}
+
+/**
+ * @note Integer sums are done on unsigned types, so that they wrap around
+ * instead of overflowing.
+ */
+static void
+array_sumscalar (Arraytype type, const char *p, int n, void *sum)
+{
+  int i;
+  int32_t x32;
+  int64_t x64, isum;
+  float xf;
+  double xd, dsum;
+
+  if (type == ARRAY_INT32 || type == ARRAY_INT64)
+    {
+      memcpy (&isum, sum, sizeof (int64_t));
+      for (i = 0; i < n; i++)
+	if (type == ARRAY_INT32)
+	  {
+	    memcpy (&x32, p + (size_t) i * sizeof (int32_t), sizeof (int32_t));
+	    isum = (int64_t) ((uint64_t) isum + (uint64_t) (int64_t) x32);
+	  }
+	else
+	  {
+	    memcpy (&x64, p + (size_t) i * sizeof (int64_t), sizeof (int64_t));
+	    isum = (int64_t) ((uint64_t) isum + (uint64_t) x64);
+	  }
+      memcpy (sum, &isum, sizeof (int64_t));
+    }
+  else
+    {
+      memcpy (&dsum, sum, sizeof (double));
+      for (i = 0; i < n; i++)
+	if (type == ARRAY_FLOAT)
+	  {
+	    memcpy (&xf, p + (size_t) i * sizeof (float), sizeof (float));
+	    dsum += xf;
+	  }
+	else
+	  {
+	    memcpy (&xd, p + (size_t) i * sizeof (double), sizeof (double));
+	    dsum += xd;
+	  }
+      memcpy (sum, &dsum, sizeof (double));
+    }
+}
+
+static void
+array_minmaxscalar (Arraytype type, const char *p, int n, void *min,
+		    void *max)
+{
+  int i;
+  int32_t *min32 = min, *max32 = max, x32;
+  int64_t *min64 = min, *max64 = max, x64;
+  float *minf = min, *maxf = max, xf;
+  double *mind = min, *maxd = max, xd;
+
+  for (i = 0; i < n; i++)
+    switch (type)
+      {
+      case ARRAY_INT32:
+	memcpy (&x32, p + (size_t) i * sizeof (int32_t), sizeof (int32_t));
+	*min32 = x32 < *min32 ? x32 : *min32;
+	*max32 = x32 > *max32 ? x32 : *max32;
+	break;
+      case ARRAY_INT64:
+	memcpy (&x64, p + (size_t) i * sizeof (int64_t), sizeof (int64_t));
+	*min64 = x64 < *min64 ? x64 : *min64;
+	*max64 = x64 > *max64 ? x64 : *max64;
+	break;
+      case ARRAY_FLOAT:
+	memcpy (&xf, p + (size_t) i * sizeof (float), sizeof (float));
+	*minf = xf < *minf ? xf : *minf;
+	*maxf = xf > *maxf ? xf : *maxf;
+	break;
+      case ARRAY_DOUBLE:
+	memcpy (&xd, p + (size_t) i * sizeof (double), sizeof (double));
+	*mind = xd < *mind ? xd : *mind;
+	*maxd = xd > *maxd ? xd : *maxd;
+	break;
+      }
+}
+
+static void
+array_prefixscalar (Arraytype type, char *p, int n, void *carry)
+{
+  int i;
+  uint32_t x32, c32;
+  uint64_t x64, c64;
+  float xf, cf;
+  double xd, cd;
+
+  switch (type)
+    {
+    case ARRAY_INT32:
+      memcpy (&c32, carry, sizeof (uint32_t));
+      for (i = 0; i < n; i++)
+	{
+	  memcpy (&x32, p + (size_t) i * sizeof (uint32_t), sizeof (uint32_t));
+	  c32 += x32;
+	  memcpy (p + (size_t) i * sizeof (uint32_t), &c32, sizeof (uint32_t));
+	}
+      memcpy (carry, &c32, sizeof (uint32_t));
+      break;
+    case ARRAY_INT64:
+      memcpy (&c64, carry, sizeof (uint64_t));
+      for (i = 0; i < n; i++)
+	{
+	  memcpy (&x64, p + (size_t) i * sizeof (uint64_t), sizeof (uint64_t));
+	  c64 += x64;
+	  memcpy (p + (size_t) i * sizeof (uint64_t), &c64, sizeof (uint64_t));
+	}
+      memcpy (carry, &c64, sizeof (uint64_t));
+      break;
+    case ARRAY_FLOAT:
+      memcpy (&cf, carry, sizeof (float));
+      for (i = 0; i < n; i++)
+	{
+	  memcpy (&xf, p + (size_t) i * sizeof (float), sizeof (float));
+	  cf += xf;
+	  memcpy (p + (size_t) i * sizeof (float), &cf, sizeof (float));
+	}
+      memcpy (carry, &cf, sizeof (float));
+      break;
+    case ARRAY_DOUBLE:
+      memcpy (&cd, carry, sizeof (double));
+      for (i = 0; i < n; i++)
+	{
+	  memcpy (&xd, p + (size_t) i * sizeof (double), sizeof (double));
+	  cd += xd;
+	  memcpy (p + (size_t) i * sizeof (double), &cd, sizeof (double));
+	}
+      memcpy (carry, &cd, sizeof (double));
+      break;
+    }
 }
 
-/**
- * @note This function should not return an out of bound value.
- */
-size_t
-array_fullsize (Array a)
-{
-  assert (!array_null (a));
-  return (((size_t) array_length (a)) * array_size (a));
+static void
+array_dotscalar (Arraytype type, const char *p1, const char *p2, int n,
+		 void *dot)
+{
+  int i;
+  int32_t x32, y32;
+  int64_t x64, y64, idot;
+  float xf, yf;
+  double xd, yd, ddot;
+
+  if (type == ARRAY_INT32 || type == ARRAY_INT64)
+    {
+      memcpy (&idot, dot, sizeof (int64_t));
+      for (i = 0; i < n; i++)
+	if (type == ARRAY_INT32)
+	  {
+	    memcpy (&x32, p1 + (size_t) i * sizeof (int32_t), sizeof (int32_t));
+	    memcpy (&y32, p2 + (size_t) i * sizeof (int32_t), sizeof (int32_t));
+	    idot = (int64_t) ((uint64_t) idot + (uint64_t) ((int64_t) x32 * y32));
+	  }
+	else
+	  {
+	    memcpy (&x64, p1 + (size_t) i * sizeof (int64_t), sizeof (int64_t));
+	    memcpy (&y64, p2 + (size_t) i * sizeof (int64_t), sizeof (int64_t));
+	    idot = (int64_t) ((uint64_t) idot + (uint64_t) x64 * (uint64_t) y64);
+	  }
+      memcpy (dot, &idot, sizeof (int64_t));
+    }
+  else
+    {
+      memcpy (&ddot, dot, sizeof (double));
+      for (i = 0; i < n; i++)
+	if (type == ARRAY_FLOAT)
+	  {
+	    memcpy (&xf, p1 + (size_t) i * sizeof (float), sizeof (float));
+	    memcpy (&yf, p2 + (size_t) i * sizeof (float), sizeof (float));
+	    ddot += (double) xf * yf;
+	  }
+	else
+	  {
+	    memcpy (&xd, p1 + (size_t) i * sizeof (double), sizeof (double));
+	    memcpy (&yd, p2 + (size_t) i * sizeof (double), sizeof (double));
+	    ddot += xd * yd;
+	  }
+      memcpy (dot, &ddot, sizeof (double));
+    }
+}
+
+static void
+array_axpyscalar (Arraytype type, char *py, const char *px, int n,
+		  const void *alpha)
+{
+  int i;
+  uint32_t x32, y32, a32;
+  uint64_t x64, y64, a64;
+  float xf, yf, af;
+  double xd, yd, ad;
+
+  for (i = 0; i < n; i++)
+    switch (type)
+      {
+      case ARRAY_INT32:
+	memcpy (&a32, alpha, sizeof (uint32_t));
+	memcpy (&x32, px + (size_t) i * sizeof (uint32_t), sizeof (uint32_t));
+	memcpy (&y32, py + (size_t) i * sizeof (uint32_t), sizeof (uint32_t));
+	y32 += a32 * x32;
+	memcpy (py + (size_t) i * sizeof (uint32_t), &y32, sizeof (uint32_t));
+	break;
+      case ARRAY_INT64:
+	memcpy (&a64, alpha, sizeof (uint64_t));
+	memcpy (&x64, px + (size_t) i * sizeof (uint64_t), sizeof (uint64_t));
+	memcpy (&y64, py + (size_t) i * sizeof (uint64_t), sizeof (uint64_t));
+	y64 += a64 * x64;
+	memcpy (py + (size_t) i * sizeof (uint64_t), &y64, sizeof (uint64_t));
+	break;
+      case ARRAY_FLOAT:
+	memcpy (&af, alpha, sizeof (float));
+	memcpy (&xf, px + (size_t) i * sizeof (float), sizeof (float));
+	memcpy (&yf, py + (size_t) i * sizeof (float), sizeof (float));
+	yf += af * xf;
+	memcpy (py + (size_t) i * sizeof (float), &yf, sizeof (float));
+	break;
+      case ARRAY_DOUBLE:
+	memcpy (&ad, alpha, sizeof (double));
+	memcpy (&xd, px + (size_t) i * sizeof (double), sizeof (double));
+	memcpy (&yd, py + (size_t) i * sizeof (double), sizeof (double));
+	yd += ad * xd;
+	memcpy (py + (size_t) i * sizeof (double), &yd, sizeof (double));
+	break;
+      }
+}
+
+#if defined (SALIBC_X86) || DOXYGEN
+
+/**
+ * @note 32 bit integers are sign extended to 64 bits, and floats are
+ * converted to doubles, before being added.
+ */
+static void
+array_sumsse2 (Arraytype type, const char *p, int n, void *sum)
+{
+  int i = 0, lanes = 0;
+  int64_t ilanes[2];
+  double dlanes[2];
+  __m128i v, iacc = _mm_setzero_si128 ();
+  __m128 vf;
+  __m128d dacc = _mm_setzero_pd ();
+
+  switch (type)
+    {
+    case ARRAY_INT32:
+      for (lanes = 4; i + 4 <= n; i += 4)
+	{
+	  v = _mm_loadu_si128 ((const __m128i *) (p + (size_t) i * 4));
+	  iacc = _mm_add_epi64 (iacc, _mm_unpacklo_epi32
+				(v, _mm_cmpgt_epi32 (_mm_setzero_si128 (),
+						     v)));
+	  iacc = _mm_add_epi64 (iacc, _mm_unpackhi_epi32
+				(v, _mm_cmpgt_epi32 (_mm_setzero_si128 (),
+						     v)));
+	}
+      break;
+    case ARRAY_INT64:
+      for (lanes = 2; i + 2 <= n; i += 2)
+	iacc = _mm_add_epi64 (iacc, _mm_loadu_si128 ((const __m128i *)
+						     (p + (size_t) i * 8)));
+      break;
+    case ARRAY_FLOAT:
+      for (lanes = 4; i + 4 <= n; i += 4)
+	{
+	  vf = _mm_loadu_ps ((const float *) (p + (size_t) i * 4));
+	  dacc = _mm_add_pd (dacc, _mm_cvtps_pd (vf));
+	  dacc = _mm_add_pd (dacc, _mm_cvtps_pd (_mm_movehl_ps (vf, vf)));
+	}
+      break;
+    case ARRAY_DOUBLE:
+      for (lanes = 2; i + 2 <= n; i += 2)
+	dacc = _mm_add_pd (dacc, _mm_loadu_pd ((const double *)
+					       (p + (size_t) i * 8)));
+      break;
+    }
+
+  _mm_storeu_si128 ((__m128i *) ilanes, iacc);
+  _mm_storeu_pd (dlanes, dacc);
+  if (type == ARRAY_INT32 || type == ARRAY_INT64)
+    array_sumscalar (ARRAY_INT64, (const char *) ilanes, 2, sum);
+  else
+    array_sumscalar (ARRAY_DOUBLE, (const char *) dlanes, 2, sum);
+
+  array_sumscalar (type, p + (size_t) i * (size_t) (16 / lanes), n - i, sum);
+}
+
+static void
+array_sumavx2 (Arraytype type, const char *p, int n, void *sum)
+{
+  int i = 0, lanes = 0;
+  int64_t ilanes[4];
+  double dlanes[4];
+  __m256i v, iacc = _mm256_setzero_si256 ();
+  __m256 vf;
+  __m256d dacc = _mm256_setzero_pd ();
+
+  switch (type)
+    {
+    case ARRAY_INT32:
+      for (lanes = 8; i + 8 <= n; i += 8)
+	{
+	  v = _mm256_loadu_si256 ((const __m256i *) (p + (size_t) i * 4));
+	  iacc = _mm256_add_epi64 (iacc, _mm256_cvtepi32_epi64
+				   (_mm256_castsi256_si128 (v)));
+	  iacc = _mm256_add_epi64 (iacc, _mm256_cvtepi32_epi64
+				   (_mm256_extracti128_si256 (v, 1)));
+	}
+      break;
+    case ARRAY_INT64:
+      for (lanes = 4; i + 4 <= n; i += 4)
+	iacc = _mm256_add_epi64 (iacc, _mm256_loadu_si256 ((const __m256i *)
+							   (p +
+							    (size_t) i * 8)));
+      break;
+    case ARRAY_FLOAT:
+      for (lanes = 8; i + 8 <= n; i += 8)
+	{
+	  vf = _mm256_loadu_ps ((const float *) (p + (size_t) i * 4));
+	  dacc = _mm256_add_pd (dacc, _mm256_cvtps_pd
+				(_mm256_castps256_ps128 (vf)));
+	  dacc = _mm256_add_pd (dacc, _mm256_cvtps_pd
+				(_mm256_extractf128_ps (vf, 1)));
+	}
+      break;
+    case ARRAY_DOUBLE:
+      for (lanes = 4; i + 4 <= n; i += 4)
+	dacc = _mm256_add_pd (dacc, _mm256_loadu_pd ((const double *)
+						     (p + (size_t) i * 8)));
+      break;
+    }
+
+  _mm256_storeu_si256 ((__m256i *) ilanes, iacc);
+  _mm256_storeu_pd (dlanes, dacc);
+  if (type == ARRAY_INT32 || type == ARRAY_INT64)
+    array_sumscalar (ARRAY_INT64, (const char *) ilanes, 4, sum);
+  else
+    array_sumscalar (ARRAY_DOUBLE, (const char *) dlanes, 4, sum);
+
+  array_sumscalar (type, p + (size_t) i * (size_t) (32 / lanes), n - i, sum);
+}
+
+/**
+ * @note SSE2 has no 32 bit integer minimum, so it is done with a compare and
+ * a select. 64 bit integers are left to the scalar kernel.
+ */
+static void
+array_minmaxsse2 (Arraytype type, const char *p, int n, void *min, void *max)
+{
+  int i = 0;
+  char lanes[2][16];
+  size_t size = type == ARRAY_INT32 || type == ARRAY_FLOAT ? 4 : 8;
+  __m128i v, vmin, vmax, mask;
+  __m128 vf, vminf, vmaxf;
+  __m128d vd, vmind, vmaxd;
+
+  switch (type)
+    {
+    case ARRAY_INT32:
+      vmin = vmax = _mm_set1_epi32 (*((const int32_t *) min));
+      for (; i + 4 <= n; i += 4)
+	{
+	  v = _mm_loadu_si128 ((const __m128i *) (p + (size_t) i * 4));
+	  mask = _mm_cmpgt_epi32 (vmin, v);
+	  vmin = _mm_or_si128 (_mm_and_si128 (mask, v),
+			       _mm_andnot_si128 (mask, vmin));
+	  mask = _mm_cmpgt_epi32 (v, vmax);
+	  vmax = _mm_or_si128 (_mm_and_si128 (mask, v),
+			       _mm_andnot_si128 (mask, vmax));
+	}
+      _mm_storeu_si128 ((__m128i *) lanes[0], vmin);
+      _mm_storeu_si128 ((__m128i *) lanes[1], vmax);
+      break;
+    case ARRAY_FLOAT:
+      vminf = vmaxf = _mm_set1_ps (*((const float *) min));
+      for (; i + 4 <= n; i += 4)
+	{
+	  vf = _mm_loadu_ps ((const float *) (p + (size_t) i * 4));
+	  vminf = _mm_min_ps (vf, vminf);
+	  vmaxf = _mm_max_ps (vf, vmaxf);
+	}
+      _mm_storeu_ps ((float *) lanes[0], vminf);
+      _mm_storeu_ps ((float *) lanes[1], vmaxf);
+      break;
+    case ARRAY_DOUBLE:
+      vmind = vmaxd = _mm_set1_pd (*((const double *) min));
+      for (; i + 2 <= n; i += 2)
+	{
+	  vd = _mm_loadu_pd ((const double *) (p + (size_t) i * 8));
+	  vmind = _mm_min_pd (vd, vmind);
+	  vmaxd = _mm_max_pd (vd, vmaxd);
+	}
+      _mm_storeu_pd ((double *) lanes[0], vmind);
+      _mm_storeu_pd ((double *) lanes[1], vmaxd);
+      break;
+    case ARRAY_INT64:
+      break;
+    }
+
+  if (type != ARRAY_INT64)
+    {
+      array_minmaxscalar (type, lanes[0], (int) (16 / size), min, max);
+      array_minmaxscalar (type, lanes[1], (int) (16 / size), min, max);
+    }
+  array_minmaxscalar (type, p + (size_t) i * size, n - i, min, max);
+}
+
+static void
+array_minmaxavx2 (Arraytype type, const char *p, int n, void *min, void *max)
+{
+  int i = 0;
+  char lanes[2][32];
+  size_t size = type == ARRAY_INT32 || type == ARRAY_FLOAT ? 4 : 8;
+  __m256i v, vmin, vmax;
+  __m256 vf, vminf, vmaxf;
+  __m256d vd, vmind, vmaxd;
+
+  switch (type)
+    {
+    case ARRAY_INT32:
+      vmin = vmax = _mm256_set1_epi32 (*((const int32_t *) min));
+      for (; i + 8 <= n; i += 8)
+	{
+	  v = _mm256_loadu_si256 ((const __m256i *) (p + (size_t) i * 4));
+	  vmin = _mm256_min_epi32 (vmin, v);
+	  vmax = _mm256_max_epi32 (vmax, v);
+	}
+      _mm256_storeu_si256 ((__m256i *) lanes[0], vmin);
+      _mm256_storeu_si256 ((__m256i *) lanes[1], vmax);
+      break;
+    case ARRAY_INT64:
+      vmin = vmax = _mm256_set1_epi64x (*((const int64_t *) min));
+      for (; i + 4 <= n; i += 4)
+	{
+	  v = _mm256_loadu_si256 ((const __m256i *) (p + (size_t) i * 8));
+	  vmin = _mm256_blendv_epi8 (vmin, v, _mm256_cmpgt_epi64 (vmin, v));
+	  vmax = _mm256_blendv_epi8 (vmax, v, _mm256_cmpgt_epi64 (v, vmax));
+	}
+      _mm256_storeu_si256 ((__m256i *) lanes[0], vmin);
+      _mm256_storeu_si256 ((__m256i *) lanes[1], vmax);
+      break;
+    case ARRAY_FLOAT:
+      vminf = vmaxf = _mm256_set1_ps (*((const float *) min));
+      for (; i + 8 <= n; i += 8)
+	{
+	  vf = _mm256_loadu_ps ((const float *) (p + (size_t) i * 4));
+	  vminf = _mm256_min_ps (vf, vminf);
+	  vmaxf = _mm256_max_ps (vf, vmaxf);
+	}
+      _mm256_storeu_ps ((float *) lanes[0], vminf);
+      _mm256_storeu_ps ((float *) lanes[1], vmaxf);
+      break;
+    case ARRAY_DOUBLE:
+      vmind = vmaxd = _mm256_set1_pd (*((const double *) min));
+      for (; i + 4 <= n; i += 4)
+	{
+	  vd = _mm256_loadu_pd ((const double *) (p + (size_t) i * 8));
+	  vmind = _mm256_min_pd (vd, vmind);
+	  vmaxd = _mm256_max_pd (vd, vmaxd);
+	}
+      _mm256_storeu_pd ((double *) lanes[0], vmind);
+      _mm256_storeu_pd ((double *) lanes[1], vmaxd);
+      break;
+    }
+
+  array_minmaxscalar (type, lanes[0], (int) (32 / size), min, max);
+  array_minmaxscalar (type, lanes[1], (int) (32 / size), min, max);
+  array_minmaxscalar (type, p + (size_t) i * size, n - i, min, max);
+}
+
+/**
+ * @note Each block is summed inside the register with two shifted adds
+ * (one for two lane registers), then the carry of the previous blocks is
+ * added and the last lane becomes the new carry.
+ */
+static void
+array_prefixsse2 (Arraytype type, char *p, int n, void *carry)
+{
+  int i = 0;
+  size_t size = type == ARRAY_INT32 || type == ARRAY_FLOAT ? 4 : 8;
+  __m128i v, c;
+  __m128 vf, cf;
+  __m128d vd, cd;
+
+  switch (type)
+    {
+    case ARRAY_INT32:
+      c = _mm_set1_epi32 (*((const int32_t *) carry));
+      for (; i + 4 <= n; i += 4)
+	{
+	  v = _mm_loadu_si128 ((const __m128i *) (p + (size_t) i * 4));
+	  v = _mm_add_epi32 (v, _mm_slli_si128 (v, 4));
+	  v = _mm_add_epi32 (v, _mm_slli_si128 (v, 8));
+	  v = _mm_add_epi32 (v, c);
+	  _mm_storeu_si128 ((__m128i *) (p + (size_t) i * 4), v);
+	  c = _mm_shuffle_epi32 (v, 0xff);
+	}
+      *((int32_t *) carry) = _mm_cvtsi128_si32 (c);
+      break;
+    case ARRAY_INT64:
+      c = _mm_set1_epi64x (*((const int64_t *) carry));
+      for (; i + 2 <= n; i += 2)
+	{
+	  v = _mm_loadu_si128 ((const __m128i *) (p + (size_t) i * 8));
+	  v = _mm_add_epi64 (v, _mm_slli_si128 (v, 8));
+	  v = _mm_add_epi64 (v, c);
+	  _mm_storeu_si128 ((__m128i *) (p + (size_t) i * 8), v);
+	  c = _mm_shuffle_epi32 (v, 0xee);
+	}
+      _mm_storel_epi64 ((__m128i *) carry, c);
+      break;
+    case ARRAY_FLOAT:
+      cf = _mm_set1_ps (*((const float *) carry));
+      for (; i + 4 <= n; i += 4)
+	{
+	  vf = _mm_loadu_ps ((const float *) (p + (size_t) i * 4));
+	  vf = _mm_add_ps (vf, _mm_castsi128_ps
+			   (_mm_slli_si128 (_mm_castps_si128 (vf), 4)));
+	  vf = _mm_add_ps (vf, _mm_castsi128_ps
+			   (_mm_slli_si128 (_mm_castps_si128 (vf), 8)));
+	  vf = _mm_add_ps (vf, cf);
+	  _mm_storeu_ps ((float *) (p + (size_t) i * 4), vf);
+	  cf = _mm_shuffle_ps (vf, vf, 0xff);
+	}
+      _mm_store_ss ((float *) carry, cf);
+      break;
+    case ARRAY_DOUBLE:
+      cd = _mm_set1_pd (*((const double *) carry));
+      for (; i + 2 <= n; i += 2)
+	{
+	  vd = _mm_loadu_pd ((const double *) (p + (size_t) i * 8));
+	  vd = _mm_add_pd (vd, _mm_castsi128_pd
+			   (_mm_slli_si128 (_mm_castpd_si128 (vd), 8)));
+	  vd = _mm_add_pd (vd, cd);
+	  _mm_storeu_pd ((double *) (p + (size_t) i * 8), vd);
+	  cd = _mm_unpackhi_pd (vd, vd);
+	}
+      _mm_store_sd ((double *) carry, cd);
+      break;
+    }
+
+  array_prefixscalar (type, p + (size_t) i * size, n - i, carry);
+}
+
+/**
+ * @note SSE2 has no signed 32 bit multiplication into 64 bits, so integer
+ * dot products are left to the scalar kernel.
+ */
+static void
+array_dotsse2 (Arraytype type, const char *p1, const char *p2, int n,
+	       void *dot)
+{
+  int i = 0;
+  size_t size = type == ARRAY_INT32 || type == ARRAY_FLOAT ? 4 : 8;
+  double dlanes[2];
+  __m128 xf, yf;
+  __m128d dacc = _mm_setzero_pd ();
+
+  if (type == ARRAY_FLOAT)
+    for (; i + 4 <= n; i += 4)
+      {
+	xf = _mm_loadu_ps ((const float *) (p1 + (size_t) i * 4));
+	yf = _mm_loadu_ps ((const float *) (p2 + (size_t) i * 4));
+	dacc = _mm_add_pd (dacc, _mm_mul_pd (_mm_cvtps_pd (xf),
+					     _mm_cvtps_pd (yf)));
+	dacc = _mm_add_pd (dacc, _mm_mul_pd (_mm_cvtps_pd
+					     (_mm_movehl_ps (xf, xf)),
+					     _mm_cvtps_pd
+					     (_mm_movehl_ps (yf, yf))));
+      }
+  else if (type == ARRAY_DOUBLE)
+    for (; i + 2 <= n; i += 2)
+      dacc = _mm_add_pd (dacc, _mm_mul_pd
+			 (_mm_loadu_pd ((const double *) (p1 + (size_t) i * 8)),
+			  _mm_loadu_pd ((const double *)
+					(p2 + (size_t) i * 8))));
+
+  if (i > 0)
+    {
+      _mm_storeu_pd (dlanes, dacc);
+      array_sumscalar (ARRAY_DOUBLE, (const char *) dlanes, 2, dot);
+    }
+  array_dotscalar (type, p1 + (size_t) i * size, p2 + (size_t) i * size,
+		   n - i, dot);
+}
+
+/**
+ * @note 32 bit integers are sign extended to 64 bits so that the products
+ * are exact. There is no 64 bit integer multiplication in AVX2, so those are
+ * left to the scalar kernel.
+ */
+static void
+array_dotavx2 (Arraytype type, const char *p1, const char *p2, int n,
+	       void *dot)
+{
+  int i = 0;
+  size_t size = type == ARRAY_INT32 || type == ARRAY_FLOAT ? 4 : 8;
+  int64_t ilanes[4];
+  double dlanes[4];
+  __m256i x, y, iacc = _mm256_setzero_si256 ();
+  __m256 xf, yf;
+  __m256d dacc = _mm256_setzero_pd ();
+
+  switch (type)
+    {
+    case ARRAY_INT32:
+      for (; i + 8 <= n; i += 8)
+	{
+	  x = _mm256_loadu_si256 ((const __m256i *) (p1 + (size_t) i * 4));
+	  y = _mm256_loadu_si256 ((const __m256i *) (p2 + (size_t) i * 4));
+	  iacc = _mm256_add_epi64 (iacc, _mm256_mul_epi32
+				   (_mm256_cvtepi32_epi64
+				    (_mm256_castsi256_si128 (x)),
+				    _mm256_cvtepi32_epi64
+				    (_mm256_castsi256_si128 (y))));
+	  iacc = _mm256_add_epi64 (iacc, _mm256_mul_epi32
+				   (_mm256_cvtepi32_epi64
+				    (_mm256_extracti128_si256 (x, 1)),
+				    _mm256_cvtepi32_epi64
+				    (_mm256_extracti128_si256 (y, 1))));
+	}
+      _mm256_storeu_si256 ((__m256i *) ilanes, iacc);
+      array_sumscalar (ARRAY_INT64, (const char *) ilanes, 4, dot);
+      break;
+    case ARRAY_FLOAT:
+      for (; i + 8 <= n; i += 8)
+	{
+	  xf = _mm256_loadu_ps ((const float *) (p1 + (size_t) i * 4));
+	  yf = _mm256_loadu_ps ((const float *) (p2 + (size_t) i * 4));
+	  dacc = _mm256_add_pd (dacc, _mm256_mul_pd
+				(_mm256_cvtps_pd (_mm256_castps256_ps128 (xf)),
+				 _mm256_cvtps_pd (_mm256_castps256_ps128
+						  (yf))));
+	  dacc = _mm256_add_pd (dacc, _mm256_mul_pd
+				(_mm256_cvtps_pd (_mm256_extractf128_ps
+						  (xf, 1)),
+				 _mm256_cvtps_pd (_mm256_extractf128_ps
+						  (yf, 1))));
+	}
+      _mm256_storeu_pd (dlanes, dacc);
+      array_sumscalar (ARRAY_DOUBLE, (const char *) dlanes, 4, dot);
+      break;
+    case ARRAY_DOUBLE:
+      for (; i + 4 <= n; i += 4)
+	dacc = _mm256_add_pd (dacc, _mm256_mul_pd
+			      (_mm256_loadu_pd ((const double *)
+						(p1 + (size_t) i * 8)),
+			       _mm256_loadu_pd ((const double *)
+						(p2 + (size_t) i * 8))));
+      _mm256_storeu_pd (dlanes, dacc);
+      array_sumscalar (ARRAY_DOUBLE, (const char *) dlanes, 4, dot);
+      break;
+    case ARRAY_INT64:
+      break;
+    }
+
+  array_dotscalar (type, p1 + (size_t) i * size, p2 + (size_t) i * size,
+		   n - i, dot);
+}
+
+/**
+ * @note SSE2 has no 32 bit integer multiplication that keeps the low half,
+ * so integer arrays are left to the scalar kernel.
+ */
+static void
+array_axpysse2 (Arraytype type, char *py, const char *px, int n,
+		const void *alpha)
+{
+  int i = 0;
+  size_t size = type == ARRAY_INT32 || type == ARRAY_FLOAT ? 4 : 8;
+  __m128 af;
+  __m128d ad;
+
+  if (type == ARRAY_FLOAT)
+    for (af = _mm_set1_ps (*((const float *) alpha)); i + 4 <= n; i += 4)
+      _mm_storeu_ps ((float *) (py + (size_t) i * 4), _mm_add_ps
+		     (_mm_loadu_ps ((const float *) (py + (size_t) i * 4)),
+		      _mm_mul_ps (af, _mm_loadu_ps ((const float *)
+						    (px + (size_t) i * 4)))));
+  else if (type == ARRAY_DOUBLE)
+    for (ad = _mm_set1_pd (*((const double *) alpha)); i + 2 <= n; i += 2)
+      _mm_storeu_pd ((double *) (py + (size_t) i * 8), _mm_add_pd
+		     (_mm_loadu_pd ((const double *) (py + (size_t) i * 8)),
+		      _mm_mul_pd (ad, _mm_loadu_pd ((const double *)
+						    (px + (size_t) i * 8)))));
+
+  array_axpyscalar (type, py + (size_t) i * size, px + (size_t) i * size,
+		    n - i, alpha);
+}
+
+/**
+ * @note The multiplication and the addition are kept separate, without
+ * FMA, so that the results are the same as the other kernels.
+ */
+static void
+array_axpyavx2 (Arraytype type, char *py, const char *px, int n,
+		const void *alpha)
+{
+  int i = 0;
+  size_t size = type == ARRAY_INT32 || type == ARRAY_FLOAT ? 4 : 8;
+  __m256i a;
+  __m256 af;
+  __m256d ad;
+
+  switch (type)
+    {
+    case ARRAY_INT32:
+      for (a = _mm256_set1_epi32 (*((const int32_t *) alpha)); i + 8 <= n;
+	   i += 8)
+	_mm256_storeu_si256 ((__m256i *) (py + (size_t) i * 4),
+			     _mm256_add_epi32
+			     (_mm256_loadu_si256 ((const __m256i *)
+						  (py + (size_t) i * 4)),
+			      _mm256_mullo_epi32
+			      (a, _mm256_loadu_si256 ((const __m256i *)
+						      (px +
+						       (size_t) i * 4)))));
+      break;
+    case ARRAY_FLOAT:
+      for (af = _mm256_set1_ps (*((const float *) alpha)); i + 8 <= n; i += 8)
+	_mm256_storeu_ps ((float *) (py + (size_t) i * 4), _mm256_add_ps
+			  (_mm256_loadu_ps ((const float *)
+					    (py + (size_t) i * 4)),
+			   _mm256_mul_ps (af, _mm256_loadu_ps ((const float *)
+							       (px +
+								(size_t) i *
+								4)))));
+      break;
+    case ARRAY_DOUBLE:
+      for (ad = _mm256_set1_pd (*((const double *) alpha)); i + 4 <= n;
+	   i += 4)
+	_mm256_storeu_pd ((double *) (py + (size_t) i * 8), _mm256_add_pd
+			  (_mm256_loadu_pd ((const double *)
+					    (py + (size_t) i * 8)),
+			   _mm256_mul_pd (ad, _mm256_loadu_pd ((const double *)
+							       (px +
+								(size_t) i *
+								8)))));
+      break;
+    case ARRAY_INT64:
+      break;
+    }
+
+  array_axpyscalar (type, py + (size_t) i * size, px + (size_t) i * size,
+		    n - i, alpha);
+}
+#endif
+
+Arraysimd
+array_simd (void)
+{
+#if defined (SALIBC_X86)
+  if (array_simdlimit >= ARRAY_AVX2 && __builtin_cpu_supports ("avx2"))
+    return ARRAY_AVX2;
+  if (array_simdlimit >= ARRAY_SSE2 && __builtin_cpu_supports ("sse2"))
+    return ARRAY_SSE2;
+#endif
+  return ARRAY_SCALAR;
+}
+
+void
+array_setsimd (Arraysimd level)
+{
+  array_simdlimit = level;
+}
+
+bool
+array_sum (Array a, Arraytype type, void *sum)
+{
+  int64_t isum = 0;
+  double dsum = 0;
+
+  if (!array_typecheck (a, type) || element_null (sum))
+    return false;
+
+  if (type == ARRAY_INT32 || type == ARRAY_INT64)
+    memcpy (sum, &isum, sizeof (int64_t));
+  else
+    memcpy (sum, &dsum, sizeof (double));
+
+  switch (array_simd ())
+    {
+#if defined (SALIBC_X86)
+    case ARRAY_AVX2:
+      array_sumavx2 (type, array_pointer (a), array_length (a), sum);
+      break;
+    case ARRAY_SSE2:
+      array_sumsse2 (type, array_pointer (a), array_length (a), sum);
+      break;
+#endif
+    default:
+      array_sumscalar (type, array_pointer (a), array_length (a), sum);
+      break;
+    }
+
+  return true;
 }
 
-char *
-array_pointer (Array a)
+static int
+array_findnumber (Arraytype type, const char *p, int n,
+		  const union Arrayvalue *value)
 {
-  if (array_null (a))
-    return NULL;
+  int i;
+  size_t size = type == ARRAY_INT32 || type == ARRAY_FLOAT ? 4 : 8;
+  float xf;
+  double xd;
 
-  return (a->ptr);
+  for (i = 0; i < n; i++)
+    switch (type)
+      {
+      case ARRAY_FLOAT:
+	memcpy (&xf, p + (size_t) i * size, sizeof (float));
+	if (value == NULL ? xf == xf : xf == value->f)
+	  return i;
+	break;
+      case ARRAY_DOUBLE:
+	memcpy (&xd, p + (size_t) i * size, sizeof (double));
+	if (value == NULL ? xd == xd : xd == value->d)
+	  return i;
+	break;
+      default:
+	if (value == NULL || memcmp (p + (size_t) i * size, value, size) == 0)
+	  return i;
+	break;
+      }
+
+  return n;
 }
 
 /**
- * @note memcmp works well in checking equality even for floating point
- * numbers.
+ * @note The vector kernels only find the extreme values; the indices are
+ * then found with a scalar scan, so that ties resolve to the first index
+ * whatever the instruction set. NaN elements are skipped: the kernels start
+ * from the first element that is not NaN, and the vector ones pass each
+ * element as the first operand of min and max, which then return the
+ * second one if the element is NaN.
  */
 bool
-array_equal (Array a1, Array a2)
+array_minmax (Array a, Arraytype type, int *argmin, int *argmax)
 {
-  if (array_null (a1) || array_null (a2))
+  int first, n;
+  union Arrayvalue min, max;
+  char *p;
+
+  if (!array_typecheck (a, type) || array_length (a) == 0)
     return false;
 
-  if ((array_length (a1) == array_length (a2))
-      && (array_fullsize (a1) == array_fullsize (a2))
-      && (memcmp (array_pointer (a1), array_pointer (a2), array_fullsize (a1))
-	  == 0))
-    return true;
+  p = array_pointer (a);
+  n = array_length (a);
+  first = array_findnumber (type, p, n, NULL);
+  if (first == n)
+    {
+      if (argmin != NULL)
+	*argmin = 0;
+      if (argmax != NULL)
+	*argmax = 0;
+      return true;
+    }
+  memcpy (&min, p + (size_t) first * array_size (a), array_size (a));
+  memcpy (&max, p + (size_t) first * array_size (a), array_size (a));
 
-  return false;
+  switch (array_simd ())
+    {
+#if defined (SALIBC_X86)
+    case ARRAY_AVX2:
+      array_minmaxavx2 (type, p + (size_t) first * array_size (a),
+			n - first, &min, &max);
+      break;
+    case ARRAY_SSE2:
+      array_minmaxsse2 (type, p + (size_t) first * array_size (a),
+			n - first, &min, &max);
+      break;
+#endif
+    default:
+      array_minmaxscalar (type, p + (size_t) first * array_size (a),
+			  n - first, &min, &max);
+      break;
+    }
+
+  if (argmin != NULL)
+    *argmin = array_findnumber (type, p, n, &min);
+  if (argmax != NULL)
+    *argmax = array_findnumber (type, p, n, &max);
+
+  return true;
 }
 
 /**
- * @note This function is also known as the array constructor.
+ * @note The exclusive version is computed as the inclusive one shifted by
+ * one element.
  */
-Array
-array_new (int nmemb, size_t size)
+bool
+array_prefixsum (Array a, Arraytype type, bool inclusive)
 {
-  Array new_array = NULL;
+  double carry = 0;
+  char *p;
+  Hashindex hi;
 
-  if (nmemb >= 0 && size > 0)
+  if (!array_typecheck (a, type))
+    return false;
+
+  hi = array_suspendindex (a);
+  array_writebegin (a);
+  p = array_pointer (a);
+  switch (array_simd ())
     {
-      new_array = malloc (sizeof (struct Array));
-      if (element_null (new_array))
-	return NULL;
+#if defined (SALIBC_X86)
+    case ARRAY_AVX2:
+    case ARRAY_SSE2:
+      array_prefixsse2 (type, p, array_length (a), &carry);
+      break;
+#endif
+    default:
+      array_prefixscalar (type, p, array_length (a), &carry);
+      break;
+    }
 
-      new_array->size = size;
-      new_array->nmemb = nmemb;
-      new_array->ptr = calloc (nmemb, size);
-      if (element_null (array_pointer (new_array)))
-	array_delete (&new_array);
+  if (!inclusive && array_length (a) > 0)
+    {
+      memmove (p + array_size (a), p, array_fullsize (a) - array_size (a));
+      memset (p, 0, array_size (a));
     }
+  array_writeend (a);
+  array_resumeindex (a, hi);
 
-  return new_array;
+  return true;
 }
 
-void
-array_delete (Array * a_ref)
+bool
+array_dot (Array a1, Array a2, Arraytype type, void *dot)
 {
-  if (!element_null (a_ref) && !array_null (*a_ref))
+  int64_t idot = 0;
+  double ddot = 0;
+
+  if (!array_typecheck (a1, type) || !array_typecheck (a2, type)
+      || array_length (a1) != array_length (a2) || element_null (dot))
+    return false;
+
+  if (type == ARRAY_INT32 || type == ARRAY_INT64)
+    memcpy (dot, &idot, sizeof (int64_t));
+  else
+    memcpy (dot, &ddot, sizeof (double));
+
+  switch (array_simd ())
     {
-      realarray_delete (*a_ref);
-      (*a_ref)->size = 0;
-      free (*a_ref);
-      *a_ref = NULL;
+#if defined (SALIBC_X86)
+    case ARRAY_AVX2:
+      array_dotavx2 (type, array_pointer (a1), array_pointer (a2),
+		     array_length (a1), dot);
+      break;
+    case ARRAY_SSE2:
+      array_dotsse2 (type, array_pointer (a1), array_pointer (a2),
+		     array_length (a1), dot);
+      break;
+#endif
+    default:
+      array_dotscalar (type, array_pointer (a1), array_pointer (a2),
+		       array_length (a1), dot);
+      break;
     }
+
+  return true;
 }
 
 bool
-array_put (Array a, int index, void *element)
+array_axpy (Array y, Array x, Arraytype type, void *alpha)
 {
-  return (array_memcopy (a, index, element));
-}
+  Hashindex hi;
 
+  if (!array_typecheck (y, type) || !array_typecheck (x, type)
+      || array_length (y) != array_length (x) || element_null (alpha))
+    return false;
 
-bool
-array_set (Array a, void *element)
+  hi = array_suspendindex (y);
+  array_writebegin (y);
+  switch (array_simd ())
+    {
+#if defined (SALIBC_X86)
+    case ARRAY_AVX2:
+      array_axpyavx2 (type, array_pointer (y), array_pointer (x),
+		      array_length (y), alpha);
+      break;
+    case ARRAY_SSE2:
+      array_axpysse2 (type, array_pointer (y), array_pointer (x),
+		      array_length (y), alpha);
+      break;
+#endif
+    default:
+      array_axpyscalar (type, array_pointer (y), array_pointer (x),
+			array_length (y), alpha);
+      break;
+    }
+  array_writeend (y);
+  array_resumeindex (y, hi);
+
+  return true;
+}
+
+/*
+ *************************************
+ * Gather, scatter and permutations. *
+ *************************************
+ */
+static bool
+array_checkindices (Array idx, int bound)
 {
   int i;
+  const int *ix;
 
-  for (i = 0; i < array_length (a); i++)
-    {
-      if (!array_memcopy (a, i, element))
-	return false;
-    }
+  if (array_null (idx) || array_size (idx) != sizeof (int))
+    return false;
+
+  ix = (const int *) array_pointer (idx);
+  for (i = 0; i < array_length (idx); i++)
+    if (ix[i] < 0 || ix[i] >= bound)
+      return false;
 
   return true;
 }
 
+static void
+array_moveelement (char *to, const char *from, size_t size)
+{
+  if (size == sizeof (uint32_t))
+    memcpy (to, from, sizeof (uint32_t));
+  else if (size == sizeof (uint64_t))
+    memcpy (to, from, sizeof (uint64_t));
+  else
+    memcpy (to, from, size);
+}
+
+static void
+array_prefetch (const char *element, bool write)
+{
+  if (write)
+    __builtin_prefetch (element, 1);
+  else
+    __builtin_prefetch (element, 0);
+}
+
 /**
- * @note This function is an interface to array_indexpointer.
+ * @note There is one loop for 4 byte elements, one for 8 byte elements and
+ * one for the other sizes, so that the size of the copies is a constant in
+ * the first two. The indexed address ARRAY_PREFETCH elements ahead is
+ * prefetched, since random indices defeat the hardware prefetcher: for
+ * reading when gathering, for writing when scattering.
  */
-char *
-array_get (Array a, int index)
+static void
+array_reorder (char *out, const char *in, const int *idx, int n,
+	       size_t size, bool scatter)
 {
-  return (array_indexpointer (a, index));
+  int i, ahead, last = n - ARRAY_PREFETCH;
+  size_t from, to;
+  const char *hint = scatter ? out : in;
+
+  if (size == sizeof (uint32_t))
+    for (i = 0; i < n; i++)
+      {
+	ahead = i < last ? idx[i + ARRAY_PREFETCH] : idx[i];
+	array_prefetch (hint + (size_t) ahead * sizeof (uint32_t), scatter);
+	from = scatter ? (size_t) i : (size_t) idx[i];
+	to = scatter ? (size_t) idx[i] : (size_t) i;
+	memcpy (out + to * sizeof (uint32_t), in + from * sizeof (uint32_t),
+		sizeof (uint32_t));
+      }
+  else if (size == sizeof (uint64_t))
+    for (i = 0; i < n; i++)
+      {
+	ahead = i < last ? idx[i + ARRAY_PREFETCH] : idx[i];
+	array_prefetch (hint + (size_t) ahead * sizeof (uint64_t), scatter);
+	from = scatter ? (size_t) i : (size_t) idx[i];
+	to = scatter ? (size_t) idx[i] : (size_t) i;
+	memcpy (out + to * sizeof (uint64_t), in + from * sizeof (uint64_t),
+		sizeof (uint64_t));
+      }
+  else
+    for (i = 0; i < n; i++)
+      {
+	ahead = i < last ? idx[i + ARRAY_PREFETCH] : idx[i];
+	array_prefetch (hint + (size_t) ahead * size, scatter);
+	from = scatter ? (size_t) i : (size_t) idx[i];
+	to = scatter ? (size_t) idx[i] : (size_t) i;
+	memcpy (out + to * size, in + from * size, size);
+      }
 }
 
-Array
-array_copy (Array a1)
+/**
+ * @note Each index marks the element it points to, so an index that is
+ * pointed to twice is found when its element is already marked. The writes
+ * do not depend on each other, unlike a walk along the cycles.
+ */
+static bool
+array_markindices (int *perm, int n)
 {
-  int i;
-  Array a2;
+  int i, k;
 
-  if (array_null (a1))
-    return NULL;
+  for (i = 0; i < n; i++)
+    {
+      k = perm[i] < 0 ? ~perm[i] : perm[i];
+      if (perm[k] < 0)
+	{
+	  for (k = 0; k < n; k++)
+	    if (perm[k] < 0)
+	      perm[k] = ~perm[k];
+	  return false;
+	}
+      perm[k] = ~perm[k];
+    }
 
-  /**
-   * @note Allocate a new array with the same ADT characteristics.
-   */
-  /** @code */
-  a2 = array_new (array_length (a1), array_size (a1));
-  if (array_null (a2))
-    return NULL;
-  /** @endcode */
+  return true;
+}
 
-  /**
-   * @note Copy the real array using the previously defined functions.
-   */
-  /** @code */
-  for (i = 0; i < array_length (a1); i++)
-    if (!array_memcopy (a2, i, array_indexpointer (a1, i)))
-      return NULL;
-  /** @endcode */
+static void
+array_argmerge (Array a, int (*cmp) (const void *, const void *),
+		const int *in, int *out, int from, int mid, int to)
+{
+  int i = from, j = mid, k = from;
+  size_t size = array_size (a);
+  const char *base = array_pointer (a);
 
-  return a2;
+  while (i < mid && j < to)
+    if (array_compare (size, cmp, base + (size_t) in[j] * size,
+		       base + (size_t) in[i] * size) < 0)
+      out[k++] = in[j++];
+    else
+      out[k++] = in[i++];
+  memcpy (out + k, in + i, (size_t) (mid - i) * sizeof (int));
+  memcpy (out + k + (mid - i), in + j, (size_t) (to - j) * sizeof (int));
 }
 
 bool
-array_resize (Array a, int new_length)
+array_gather (Array dst, Array src, Array idx)
 {
-  char *tmp;
-  int memdiff;
+  Hashindex hi;
 
-  if (array_null (a))
-    return NULL;
-
-  /** @code */
-  /*
-   * Invalid new length.
-   */
-  if (new_length < 0)
+  if (array_null (dst) || array_null (src) || dst == src
+      || array_size (dst) != array_size (src)
+      || !array_checkindices (idx, array_length (src)))
     return false;
-  /*
-   * new_length is set to zero, so leave the ADT, but delete internal array.
-   */
-  else if (new_length == 0)
+
+  hi = array_suspendindex (dst);
+  if (!array_resize (dst, array_length (idx)))
     {
-      realarray_delete (a);
-      return true;
+      array_resumeindex (dst, hi);
+      return false;
     }
-  /*
-   * Same size as before, then do nothing.
-   */
-  else if (array_length (a) == new_length)
-    return true;
-  /*
-   * Array's length != new_length, so realloc can now be used directly.
-   */
-  else
-    {
-      /*
-       * Safe realloc (to avoid losing the stored array if realloc fails).
-       */
-      tmp =
-	realloc (array_pointer (a),
-		 array_fullsize (a) +
-		 (array_size (a) * ((size_t) new_length)));
-      if (!element_null (tmp))
-	a->ptr = tmp;
-      else
-	return false;
-      /*
-       * memset to 0 new part of the array.
-       * To do this we must go to the first byte of the new array and put 0
-       * until we get to (memdiff * a->size) bytes.
-       */
-      memdiff = new_length - array_length (a);
-      if (memdiff > 0)
-	memset (array_pointer (a) + array_fullsize (a) + array_size (a), 0,
-		((size_t) memdiff) * array_size (a));
 
-      /*
-       * Set the new array length.
-       */
-      a->nmemb = new_length;
-    }
+  array_writebegin (dst);
+  array_reorder (array_pointer (dst), array_pointer (src),
+		 (const int *) array_pointer (idx), array_length (idx),
+		 array_size (dst), false);
+  array_writeend (dst);
+  array_resumeindex (dst, hi);
 
   return true;
-  /** @endcode */
 }
 
-/**
- * @note This function alters the input.
- */
 bool
-array_append (Array a, void *element)
+array_scatter (Array dst, Array src, Array idx)
 {
-  int initial_length = array_length (a);
+  Hashindex hi;
 
-  if (array_resize (a, initial_length + 1)
-      && array_memcopy (a, initial_length, element))
-    return true;
-  else
+  if (array_null (dst) || array_null (src) || dst == src
+      || array_size (dst) != array_size (src)
+      || !array_checkindices (idx, array_length (dst))
+      || array_length (idx) != array_length (src))
     return false;
+
+  hi = array_suspendindex (dst);
+  array_writebegin (dst);
+  array_reorder (array_pointer (dst), array_pointer (src),
+		 (const int *) array_pointer (idx), array_length (idx),
+		 array_size (dst), true);
+  array_writeend (dst);
+  array_resumeindex (dst, hi);
+
+  return true;
 }
 
-char *
-array_trim (Array a)
+/**
+ * @note perm is walked twice: the first pass marks every index and checks
+ * that perm is a permutation, the second one moves the elements of each
+ * cycle and clears the marks. Along a cycle the next index is only known
+ * once perm[j] has been loaded, so each move waits for a random access and
+ * prefetching cannot help: on large arrays this is several times slower
+ * than array_gather into a second array, which is the better choice when
+ * the memory is available.
+ */
+bool
+array_permuteinplace (Array a, Array perm)
 {
-  int initial_length = array_length (a);
-  char *element, *element_copy;
+  int i, j, k, n;
+  int *p;
+  size_t size;
+  char *base, *tmp;
+  uint64_t small[2];
+  Hashindex hi;
 
-  /**
-   * @note Copy *element int *element_copy.
-   */
-  /** @code */
-  element = array_indexpointer (a, initial_length - 1);
-  element_copy = malloc (array_size (a));
-  memcpy (element_copy, element, array_size (a));
-  /** @endcode */
+  if (array_null (a) || !array_checkindices (perm, array_length (a))
+      || array_length (perm) != array_length (a))
+    return false;
 
-  if (!element_null (element_copy) && array_resize (a, initial_length - 1))
-    return element_copy;
-  else
-    return NULL;
+  n = array_length (a);
+  p = (int *) array_pointer (perm);
+  if (!array_markindices (p, n))
+    return false;
+
+  size = array_size (a);
+  tmp = size <= sizeof (small) ? (char *) small : malloc (size);
+  if (element_null (tmp))
+    {
+      for (i = 0; i < n; i++)
+	p[i] = ~p[i];
+      return false;
+    }
+
+  hi = array_suspendindex (a);
+  array_writebegin (a);
+  base = array_pointer (a);
+  for (i = 0; i < n; i++)
+    {
+      if (p[i] >= 0)
+	continue;
+
+      array_moveelement (tmp, base + (size_t) i * size, size);
+      for (j = i, k = ~p[j]; k != i; j = k, k = ~p[j])
+	{
+	  p[j] = k;
+	  array_moveelement (base + (size_t) j * size,
+			     base + (size_t) k * size, size);
+	}
+      p[j] = k;
+      array_moveelement (base + (size_t) j * size, tmp, size);
+    }
+  array_writeend (a);
+  array_resumeindex (a, hi);
+
+  if (tmp != (char *) small)
+    free (tmp);
+
+  return true;
 }
 
+/**
+ * @note This is a bottom-up merge sort of the indices: runs of
+ * ARRAY_ARGSORT_RUN indices are sorted by insertion, then merged back and
+ * forth between the result and a temporary array.
+ */
 Array
-array_merge (Array a1, Array a2)
+array_argsort (Array a, int (*cmp) (const void *, const void *))
 {
-  Array new_array;
-  int i, j, total_length = array_length (a1) + array_length (a2);
-
-  /**
-   * @note Safety controls.
-   */
-  /** @code */
-  if ((array_null (a1) && array_null (a2)) || (array_size (a1) !=
-					       array_size (a2)))
-    return NULL;
-  /** @endcode */
+  int i, j, n, key, width, from, mid, to;
+  int *in, *out, *swap;
+  size_t size;
+  const char *base;
+  Array idx, tmp;
 
-  new_array = array_new (total_length, array_size (a1));
-  if (array_null (new_array))
+  if (array_null (a))
     return NULL;
 
-  for (i = 0; i < array_length (a1); i++)
-    if (!array_memcopy (new_array, i, array_indexpointer (a1, i)))
+  n = array_length (a);
+  idx = array_new (n, sizeof (int));
+  tmp = array_new (n, sizeof (int));
+  if (array_null (idx) || array_null (tmp))
+    {
+      array_delete (&idx);
+      array_delete (&tmp);
       return NULL;
-  j = 0;
-  for (i = array_length (a1); i < total_length; i++)
+    }
+
+  size = array_size (a);
+  base = array_pointer (a);
+  in = (int *) array_pointer (idx);
+  out = (int *) array_pointer (tmp);
+  for (from = 0; from < n; from += ARRAY_ARGSORT_RUN)
+    for (i = from; i < n && i < from + ARRAY_ARGSORT_RUN; i++)
+      {
+	key = i;
+	for (j = i; j > from
+	     && array_compare (size, cmp, base + (size_t) key * size,
+			       base + (size_t) in[j - 1] * size) < 0; j--)
+	  in[j] = in[j - 1];
+	in[j] = key;
+      }
+
+  for (width = ARRAY_ARGSORT_RUN; width < n;
+       width = width > n / 2 ? n : 2 * width)
     {
-      if (!array_memcopy (new_array, i, array_indexpointer (a1, j)))
-	return NULL;
-      j++;
+      for (from = 0; from < n; from = to)
+	{
+	  mid = n - from > width ? from + width : n;
+	  to = n - mid > width ? mid + width : n;
+	  array_argmerge (a, cmp, in, out, from, mid, to);
+	}
+      swap = in;
+      in = out;
+      out = swap;
     }
 
-  return new_array;
+  if (in != (int *) array_pointer (idx))
+    memcpy (array_pointer (idx), in, (size_t) n * sizeof (int));
+  array_delete (&tmp);
+
+  return idx;
 }
@@ -44,8 +44,10 @@
 #endif
 
 #include <assert.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -76,8 +78,310 @@ typedef struct Array
    * choice.
    */
   char *ptr;
+  /**
+   * @brief Sequence counter used by the concurrent read mode.
+   *
+   * The writer makes it odd while it changes the array, and even again
+   * when it is done, so readers can detect a torn snapshot and retry.
+   */
+  unsigned int seq;
+  /**
+   * @brief Reclamation epoch of the concurrent read mode.
+   *
+   * Retired buffers are tagged with it, and array_reclaim advances it once
+   * no reader that started in the previous epoch is left.
+   */
+  uint64_t epoch;
+  /**
+   * @brief Number of active readers that started in an even and in an odd
+   * epoch.
+   */
+  unsigned int readers[2];
+  /**
+   * @brief Number of elements that fit in the buffer.
+   *
+   * This is equal to nmemb, except in the concurrent read mode where the
+   * buffer grows geometrically so that appends rarely replace it.
+   */
+  int capacity;
+  /**
+   * @brief Buffers replaced by a resize that readers may still be using.
+   *
+   * This is NULL unless the concurrent read mode has been enabled.
+   */
+  struct Array *retired;
+  /**
+   * @brief Hash index kept up to date by the array methods.
+   *
+   * This is NULL unless an index has been attached with array_attachindex.
+   */
+  struct Hashindex *hashindex;
 } *Array;
 
+/**
+ * @brief Number of chunk slots of a concurrent append array.
+ *
+ * Chunk k holds (CONCARRAY_FIRST << k) elements, so the slots are enough to
+ * cover every non negative int index.
+ */
+#define CONCARRAY_CHUNKS 32
+
+/**
+ * @brief Number of elements contained in the first chunk of a concurrent
+ * append array. This must be a power of two.
+ */
+#define CONCARRAY_FIRST 64
+
+/**
+ * @brief Concurrent append array Abstract Data Type.
+ *
+ * @struct Concarray
+ *
+ * @typedef struct Concarray *Concarray
+ *
+ * Many producer threads can append to the same instance without any lock.
+ * Elements are stored in chunks of growing size that are never moved, so
+ * a pointer returned by concarray_get stays valid while other threads keep
+ * appending.
+ */
+typedef struct Concarray
+{
+  /**
+   * @brief Size of a single element.
+   *
+   * This is expressed in bytes.
+   */
+  size_t size;
+  /**
+   * @brief Number of reserved slots, in the low 32 bits, and number of
+   * reserved slots whose chunk could not be allocated, in the high 32 bits.
+   *
+   * Both are kept in one word so that they can be read together with a
+   * single atomic load. The low half is incremented atomically by each
+   * producer, so it may count elements that have not been published yet,
+   * and it never goes past INT_MAX. Failed slots are never published, and
+   * concarray_to_array leaves them out.
+   */
+  uint64_t counts;
+  /**
+   * @brief Pointers to the chunks.
+   *
+   * Each chunk is followed by one ready flag per element, which is set once
+   * the element has been written.
+   */
+  char *chunk[CONCARRAY_CHUNKS];
+} *Concarray;
+
+/**
+ * @brief Columnar (struct of arrays) record container Abstract Data Type.
+ *
+ * @struct Colarray
+ *
+ * @typedef struct Colarray *Colarray
+ *
+ * Each field of a record is stored in its own array, and all the arrays
+ * always have the same length. Scans that only touch one field can work
+ * directly on its column.
+ */
+typedef struct Colarray
+{
+  /**
+   * @brief Number of columns.
+   */
+  int ncolumns;
+  /**
+   * @brief Offset of each field inside a record.
+   *
+   * This is expressed in bytes.
+   */
+  size_t *offset;
+  /**
+   * @brief The columns.
+   */
+  Array *column;
+} *Colarray;
+
+/**
+ * @brief Number of bits contained in a word of a bit array.
+ */
+#define BITARRAY_WORDBITS 64
+
+/**
+ * @brief Number of words of a superblock of the rank directory of a bit
+ * array.
+ */
+#define BITARRAY_SUPERWORDS 8
+
+/**
+ * @brief Packed bit array Abstract Data Type.
+ *
+ * @struct Bitarray
+ *
+ * @typedef struct Bitarray *Bitarray
+ *
+ * Bits are packed in an array of 64 bit words. The unused bits of the last
+ * word are always zero.
+ */
+typedef struct Bitarray
+{
+  /**
+   * @brief Number of bits contained in the bit array.
+   */
+  int nbits;
+  /**
+   * @brief The words, as an array of uint64_t.
+   */
+  Array words;
+  /**
+   * @brief Rank directory, as an array of int.
+   *
+   * Element s is the number of bits set before superblock s, i.e: before
+   * word s * BITARRAY_SUPERWORDS. The last element is the total count.
+   */
+  Array ranks;
+  /**
+   * @brief Tell if the rank directory matches the words.
+   *
+   * Every change to the bits clears this, and the directory is rebuilt by
+   * the next rank query.
+   */
+  bool ranked;
+} *Bitarray;
+
+/**
+ * @brief Number of integers contained in a block of a compressed integer
+ * array.
+ */
+#define CINTARRAY_BLOCK 128
+
+/**
+ * @brief Compressed integer array Abstract Data Type.
+ *
+ * @struct Cintarray
+ *
+ * @typedef struct Cintarray *Cintarray
+ *
+ * Integers are grouped in blocks of CINTARRAY_BLOCK elements. Each block
+ * stores its first integer, followed by the zigzag encoded differences
+ * between consecutive integers, bit-packed with the width that makes the
+ * block smallest. The few differences that do not fit are stored apart as
+ * exceptions, so that an outlier does not widen a whole block. Sorted or
+ * slowly changing data needs only a few bits per element.
+ */
+typedef struct Cintarray
+{
+  /**
+   * @brief Size of a single element, either 4 or 8 bytes.
+   */
+  size_t size;
+  /**
+   * @brief Number of elements contained in the compressed integer array.
+   */
+  int nmemb;
+  /**
+   * @brief Byte offset of each encoded block inside data, as an array of
+   * size_t.
+   *
+   * These are the skip offsets used by random access.
+   */
+  Array blocks;
+  /**
+   * @brief The encoded blocks, as an array of char.
+   */
+  Array data;
+  /**
+   * @brief Number of appended elements that are not encoded yet.
+   */
+  int npending;
+  /**
+   * @brief Appended elements that are not encoded yet.
+   *
+   * A block is encoded as soon as it is full.
+   */
+  uint64_t pending[CINTARRAY_BLOCK];
+} *Cintarray;
+
+/**
+ * @brief Hash index Abstract Data Type.
+ *
+ * @struct Hashindex
+ *
+ * @typedef struct Hashindex *Hashindex
+ *
+ * An open addressing table maps each distinct element value of an array to
+ * one of the indexes holding it. Indexes holding the same value are linked
+ * together, so that any of them can be updated in constant time.
+ */
+typedef struct Hashindex
+{
+  /**
+   * @brief Number of distinct values in the table.
+   */
+  int used;
+  /**
+   * @brief Number of removed entries that still occupy a slot.
+   */
+  int tombstones;
+  /**
+   * @brief The table slots. The number of slots is a power of two.
+   */
+  Array slots;
+  /**
+   * @brief Next index holding the same value, as an array of int.
+   */
+  Array next;
+  /**
+   * @brief Previous index holding the same value, as an array of int.
+   */
+  Array prev;
+} *Hashindex;
+
+/**
+ * @brief Element types understood by the numeric kernels.
+ *
+ * @typedef enum Arraytype Arraytype
+ */
+typedef enum Arraytype
+{
+  /**
+   * @brief int32_t elements.
+   */
+  ARRAY_INT32,
+  /**
+   * @brief int64_t elements.
+   */
+  ARRAY_INT64,
+  /**
+   * @brief float elements.
+   */
+  ARRAY_FLOAT,
+  /**
+   * @brief double elements.
+   */
+  ARRAY_DOUBLE
+} Arraytype;
+
+/**
+ * @brief Instruction sets used by the numeric kernels.
+ *
+ * @typedef enum Arraysimd Arraysimd
+ */
+typedef enum Arraysimd
+{
+  /**
+   * @brief Portable C code.
+   */
+  ARRAY_SCALAR,
+  /**
+   * @brief SSE2 code.
+   */
+  ARRAY_SSE2,
+  /**
+   * @brief AVX2 code.
+   */
+  ARRAY_AVX2
+} Arraysimd;
+
 /**
  * @brief Check if the array is NULL.
  *
@@ -277,4 +581,910 @@ extern char *array_trim (Array a);
  */
 extern Array array_merge (Array a1, Array a2);
 
+/**
+ * @brief Insert a new element into the array, shifting the following ones.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] index The index where the new element will be stored. This can
+ * also be equal to the length of the array.
+ * @param[in] element A memory address of the element to be inserted.
+ *
+ * @retval true Array insert successful.
+ * @retval false Array insert unsuccessful.
+ */
+extern bool array_insert (Array a, int index, void *element);
+
+/**
+ * @brief Insert consecutive elements into the array, shifting the following
+ * ones.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] index The index where the first new element will be stored.
+ * This can also be equal to the length of the array.
+ * @param[in] elements A memory address of the elements to be inserted.
+ * @param[in] nmemb The number of elements to be inserted.
+ *
+ * @retval true Array insert successful.
+ * @retval false Array insert unsuccessful.
+ *
+ * @warning elements must not point inside the array.
+ */
+extern bool array_insertrange (Array a, int index, void *elements, int nmemb);
+
+/**
+ * @brief Remove an element from the array, shifting the following ones.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] index The index of the element to be removed.
+ *
+ * @retval true Array erase successful.
+ * @retval false Array erase unsuccessful.
+ */
+extern bool array_erase (Array a, int index);
+
+/**
+ * @brief Remove consecutive elements from the array, shifting the following
+ * ones.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] index The index of the first element to be removed.
+ * @param[in] nmemb The number of elements to be removed.
+ *
+ * @retval true Array erase successful.
+ * @retval false Array erase unsuccessful.
+ */
+extern bool array_eraserange (Array a, int index, int nmemb);
+
+/**
+ * @brief Remove all the elements that satisfy a predicate.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] pred The predicate. It gets the memory address of an element
+ * and ctx, and it returns true if the element must be removed.
+ * @param[in] ctx A generic memory address passed to pred.
+ *
+ * @retval true Array compaction successful.
+ * @retval false Array compaction unsuccessful.
+ *
+ * @note The order of the remaining elements is preserved.
+ */
+extern bool array_removeif (Array a, bool (*pred) (void *, void *),
+			    void *ctx);
+
+/**
+ * @brief Remove the consecutive duplicates of a sorted array.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] cmp A qsort-like comparison function. If this is NULL, the
+ * elements are compared with memcmp.
+ *
+ * @retval true Array compaction successful.
+ * @retval false Array compaction unsuccessful.
+ */
+extern bool array_unique (Array a, int (*cmp) (const void *, const void *));
+
+/**
+ * @brief Merge two sorted arrays in a new sorted array.
+ *
+ * @param[in] a1 The pointer the first array ADT instance.
+ * @param[in] a2 The pointer the second array ADT instance.
+ * @param[in] cmp A qsort-like comparison function. If this is NULL, 4 and 8
+ * byte elements are compared as unsigned integers and the other ones with
+ * memcmp.
+ *
+ * @retval a3 The pointer to the new array ADT istance.
+ *
+ * @warning This function may return NULL if some problem occured.
+ *
+ * @note The merge is stable: on equal elements the ones of a1 come first.
+ */
+extern Array array_mergesorted (Array a1, Array a2,
+				int (*cmp) (const void *, const void *));
+
+/**
+ * @brief Merge k sorted arrays in a new sorted array.
+ *
+ * @param[in] arrays The pointers to the array ADT instances.
+ * @param[in] k The number of arrays.
+ * @param[in] cmp A qsort-like comparison function, or NULL as in
+ * array_mergesorted.
+ *
+ * @retval a The pointer to the new array ADT istance.
+ *
+ * @warning This function may return NULL if some problem occured.
+ *
+ * @note The merge is stable: on equal elements the ones of the array that
+ * comes first in arrays come first.
+ */
+extern Array array_mergek (Array * arrays, int k,
+			   int (*cmp) (const void *, const void *));
+
+/**
+ * @brief Get the elements that are in both sorted sets.
+ *
+ * @param[in] a1 The pointer the first array ADT instance.
+ * @param[in] a2 The pointer the second array ADT instance.
+ * @param[in] cmp A qsort-like comparison function, or NULL as in
+ * array_mergesorted.
+ *
+ * @retval a3 The pointer to the new array ADT istance.
+ *
+ * @warning This function may return NULL if some problem occured.
+ *
+ * @pre a1 and a2 must be sorted and without duplicates (see array_unique).
+ */
+extern Array array_intersect (Array a1, Array a2,
+			      int (*cmp) (const void *, const void *));
+
+/**
+ * @brief Get the elements that are in at least one of the sorted sets.
+ *
+ * @param[in] a1 The pointer the first array ADT instance.
+ * @param[in] a2 The pointer the second array ADT instance.
+ * @param[in] cmp A qsort-like comparison function, or NULL as in
+ * array_mergesorted.
+ *
+ * @retval a3 The pointer to the new array ADT istance.
+ *
+ * @warning This function may return NULL if some problem occured.
+ *
+ * @pre a1 and a2 must be sorted and without duplicates (see array_unique).
+ */
+extern Array array_union (Array a1, Array a2,
+			  int (*cmp) (const void *, const void *));
+
+/**
+ * @brief Get the elements of the first sorted set that are not in the
+ * second one.
+ *
+ * @param[in] a1 The pointer the first array ADT instance.
+ * @param[in] a2 The pointer the second array ADT instance.
+ * @param[in] cmp A qsort-like comparison function, or NULL as in
+ * array_mergesorted.
+ *
+ * @retval a3 The pointer to the new array ADT istance.
+ *
+ * @warning This function may return NULL if some problem occured.
+ *
+ * @pre a1 and a2 must be sorted and without duplicates (see array_unique).
+ */
+extern Array array_difference (Array a1, Array a2,
+			       int (*cmp) (const void *, const void *));
+
+/**
+ * @brief Enable the concurrent read mode of an array ADT instance.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ *
+ * @retval true The concurrent read mode is enabled.
+ * @retval false Some problem occurred.
+ *
+ * In this mode many threads can call array_read and array_readlength while
+ * one thread calls array_put, array_set, array_resize, array_append or
+ * array_trim. Buffers replaced by a resize are retired instead of freed;
+ * the buffer grows geometrically, so a sequence of appends retires only a
+ * logarithmic number of them.
+ *
+ * @warning Only one writer thread is allowed.
+ */
+extern bool array_setconcurrent (Array a);
+
+/**
+ * @brief Copy an element of the array without locking.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] index The index of the array where to get the element.
+ * @param[out] element A memory address where the element is copied.
+ *
+ * @retval true The element has been copied correctly.
+ * @retval false The index is out of bounds.
+ *
+ * @note The array and its length are read as a consistent snapshot: if a
+ * writer changes the array in the meantime, the read is retried. The reader
+ * is counted as active in the current epoch while it runs, so that
+ * array_reclaim does not free a buffer it may be using.
+ */
+extern bool array_read (Array a, int index, void *element);
+
+/**
+ * @brief Get the number of elements of the array without locking.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ *
+ * @retval a->nmemb The length of the array.
+ *
+ * @pre a must not be NULL.
+ */
+extern int array_readlength (Array a);
+
+/**
+ * @brief Free the buffers retired by the concurrent read mode.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ *
+ * Only the buffers retired before every active array_read call started are
+ * freed; the other ones are kept for a later call. Calling this regularly
+ * from the writer thread is enough to bound the retired memory.
+ *
+ * @note Readers register in one of two counters, chosen by the parity of the
+ * epoch. When no reader of the previous epoch is left, the buffers retired
+ * before the current epoch are freed and the epoch is advanced; buffers
+ * retired two epochs ago are always safe.
+ *
+ * @warning This must be called by the writer thread.
+ */
+extern void array_reclaim (Array a);
+
+/**
+ * @brief Build a hash index of the array and attach it.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ *
+ * @retval true The index has been attached.
+ * @retval false Some problem occurred.
+ *
+ * Once attached, the index is updated by array_put, array_set,
+ * array_append, array_resize and array_trim. The methods that move
+ * elements, like array_insert or array_erase, rebuild it from scratch.
+ *
+ * @warning The index must not be used by concurrent readers.
+ *
+ * @warning Writes through the memory addresses returned by array_get or
+ * array_pointer bypass the index, which then goes stale: array_find may
+ * miss or return the wrong index, and the next update of a changed element
+ * fails an assertion. Detach the index before such writes and attach it
+ * again afterwards.
+ *
+ * @note The index has at most 2^30 slots and is kept at most 3/4 full, so
+ * this fails for arrays with more distinct elements than that.
+ */
+extern bool array_attachindex (Array a);
+
+/**
+ * @brief Detach and delete the hash index of the array.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ */
+extern void array_detachindex (Array a);
+
+/**
+ * @brief Find an index holding the specified element.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] element A memory address of the element to be searched.
+ *
+ * @retval index An index of the array holding the element.
+ * @retval -1 The element is not in the array.
+ *
+ * @note This is a hash lookup if an index is attached, otherwise it is a
+ * linear scan.
+ */
+extern int array_find (Array a, void *element);
+
+/**
+ * @brief Get the instruction set used by the numeric kernels.
+ *
+ * @retval level The best instruction set supported by the processor that is
+ * not above the limit set by array_setsimd.
+ */
+extern Arraysimd array_simd (void);
+
+/**
+ * @brief Limit the instruction set used by the numeric kernels.
+ *
+ * @param[in] level The best instruction set that may be used. By default
+ * this is ARRAY_AVX2.
+ */
+extern void array_setsimd (Arraysimd level);
+
+/**
+ * @brief Sum the elements of a numeric array.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] type The type of the elements.
+ * @param[out] sum A memory address where the sum is stored, as an int64_t
+ * for integer types and as a double for floating point types.
+ *
+ * @retval true Sum successful.
+ * @retval false The size of the elements does not match type.
+ */
+extern bool array_sum (Array a, Arraytype type, void *sum);
+
+/**
+ * @brief Find the minimum and the maximum of a numeric array.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] type The type of the elements.
+ * @param[out] argmin A memory address where the index of the first minimum
+ * is stored.
+ * @param[out] argmax A memory address where the index of the first maximum
+ * is stored.
+ *
+ * @retval true Search successful.
+ * @retval false The array is empty or the size of the elements does not
+ * match type.
+ *
+ * @note NaN elements are ignored, and both indices are 0 if every element
+ * is NaN. -0 and +0 compare equal, so the first of them is reported.
+ */
+extern bool array_minmax (Array a, Arraytype type, int *argmin, int *argmax);
+
+/**
+ * @brief Replace each element of a numeric array with a prefix sum.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] type The type of the elements.
+ * @param[in] inclusive true for the sum of the elements up to the current
+ * one, false for the sum of the elements before it.
+ *
+ * @retval true Prefix sum successful.
+ * @retval false The size of the elements does not match type.
+ *
+ * @note Integer sums wrap around. Floating point sums may differ in the last
+ * bits between instruction sets.
+ */
+extern bool array_prefixsum (Array a, Arraytype type, bool inclusive);
+
+/**
+ * @brief Dot product of two numeric arrays.
+ *
+ * @param[in] a1 The pointer to the first array ADT instance.
+ * @param[in] a2 The pointer to the second array ADT instance.
+ * @param[in] type The type of the elements.
+ * @param[out] dot A memory address where the dot product is stored, as an
+ * int64_t for integer types and as a double for floating point types.
+ *
+ * @retval true Dot product successful.
+ * @retval false The arrays have different lengths or the size of the
+ * elements does not match type.
+ */
+extern bool array_dot (Array a1, Array a2, Arraytype type, void *dot);
+
+/**
+ * @brief Add a scaled numeric array to another one (y = alpha * x + y).
+ *
+ * @param[in,out] y The pointer to the array ADT instance that is updated.
+ * @param[in] x The pointer to the array ADT instance that is scaled.
+ * @param[in] type The type of the elements.
+ * @param[in] alpha A memory address of the scale factor, of type type.
+ *
+ * @retval true Operation successful.
+ * @retval false The arrays have different lengths or the size of the
+ * elements does not match type.
+ *
+ * @note Integer results wrap around.
+ */
+extern bool array_axpy (Array y, Array x, Arraytype type, void *alpha);
+
+/**
+ * @brief Copy the elements of an array selected by an index array.
+ *
+ * @param[in] dst The pointer to the destination array ADT instance. It is
+ * resized to the length of idx.
+ * @param[in] src The pointer to the source array ADT instance.
+ * @param[in] idx The pointer to an array ADT instance of int indices of src.
+ *
+ * @retval true Gather successful.
+ * @retval false Gather unsuccessful.
+ *
+ * After the call, element i of dst is element idx[i] of src. dst and src
+ * must be different arrays with the same element size, and every index must
+ * be valid for src; otherwise nothing is changed.
+ */
+extern bool array_gather (Array dst, Array src, Array idx);
+
+/**
+ * @brief Copy the elements of an array to the places given by an index
+ * array.
+ *
+ * @param[in] dst The pointer to the destination array ADT instance.
+ * @param[in] src The pointer to the source array ADT instance.
+ * @param[in] idx The pointer to an array ADT instance of int indices of dst,
+ * as long as src.
+ *
+ * @retval true Scatter successful.
+ * @retval false Scatter unsuccessful.
+ *
+ * After the call, element idx[i] of dst is element i of src. If an index is
+ * repeated, the last element written to it is kept.
+ */
+extern bool array_scatter (Array dst, Array src, Array idx);
+
+/**
+ * @brief Reorder an array by a permutation without copying it.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] perm The pointer to an array ADT instance of int that holds a
+ * permutation of the indices of a.
+ *
+ * @retval true Reorder successful.
+ * @retval false Reorder unsuccessful: perm is not a permutation of the
+ * indices of a, and nothing is changed.
+ *
+ * After the call, element i of a is the old element perm[i], as with
+ * array_gather.
+ *
+ * @note The cycles of the permutation are followed, so only one element is
+ * kept aside at a time. perm is used to mark the visited indices and it is
+ * restored before returning.
+ *
+ * @warning Following a cycle is a chain of dependent random accesses, so on
+ * arrays larger than the cache this is much slower than array_gather (and
+ * slower than an array_get/array_put loop into a second array). Use it only
+ * when a second array does not fit in memory.
+ */
+extern bool array_permuteinplace (Array a, Array perm);
+
+/**
+ * @brief Get the permutation that sorts an array.
+ *
+ * @param[in] a The pointer to an array ADT instance.
+ * @param[in] cmp A qsort-like comparison function, or NULL to compare 4 and
+ * 8 byte elements as unsigned integers and the other ones with memcmp.
+ *
+ * @retval idx The pointer to a new array ADT instance of int indices such
+ * that array_gather with it, or array_permuteinplace, sorts a.
+ *
+ * @warning This function may return NULL if some problem occured.
+ *
+ * @note The sort is stable: equal elements keep their order.
+ */
+extern Array array_argsort (Array a, int (*cmp) (const void *, const void *));
+
+/**
+ * @brief Create a new concurrent append array ADT instance.
+ *
+ * @param[in] size The size of each element, in bytes.
+ *
+ * @retval new_concarray A pointer to the new concurrent append array ADT
+ * instance.
+ *
+ * @warning The return value can also be NULL if some problem occurred.
+ */
+extern Concarray concarray_new (size_t size);
+
+/**
+ * @brief Delete the ADT instance of the concurrent append array.
+ *
+ * @param[in] ca_ref The memory address of the variable containing the
+ * pointer to the concurrent append array ADT instance.
+ *
+ * @warning No other thread may use the instance while it is deleted.
+ */
+extern void concarray_delete (Concarray * ca_ref);
+
+/**
+ * @brief Get the number of reserved slots of the concurrent append array.
+ *
+ * @param[in] ca The pointer to a concurrent append array ADT instance.
+ *
+ * @retval nmemb The number of reserved slots.
+ *
+ * @pre ca must not be NULL.
+ *
+ * @note While producers are running, some of the reserved slots may not be
+ * readable yet.
+ */
+extern int concarray_length (Concarray ca);
+
+/**
+ * @brief Append a new element on the concurrent append array.
+ *
+ * @param[in] ca The pointer to a concurrent append array ADT instance.
+ * @param[in] element A memory address of the element to be inserted.
+ *
+ * @retval true Append successful.
+ * @retval false Append unsuccessful.
+ *
+ * @note This function is thread safe and lock-free: the slot is reserved
+ * with an atomic fetch-add on the length. If the chunk of the slot cannot be
+ * allocated, the slot is counted as failed and stays unpublished.
+ */
+extern bool concarray_append (Concarray ca, void *element);
+
+/**
+ * @brief Get the memory address corresponding to a specified index of the
+ * concurrent append array.
+ *
+ * @param[in] ca The pointer to a concurrent append array ADT instance.
+ * @param[in] index The index where to get the element.
+ *
+ * @retval pointer A memory address corresponding to the input index.
+ *
+ * @warning This function returns NULL if the index is out of bounds or if
+ * the element has been reserved but not published yet.
+ */
+extern char *concarray_get (Concarray ca, int index);
+
+/**
+ * @brief Copy the concurrent append array into a new array ADT instance.
+ *
+ * @param[in] ca The pointer to a concurrent append array ADT instance.
+ *
+ * @retval a The pointer to the new array ADT istance.
+ *
+ * @warning This function returns NULL if some problem occured or if one of
+ * the reserved elements has not been published yet, so it should be called
+ * once all producers are done.
+ *
+ * @note The slots of failed appends are left out, so the new array may be
+ * shorter than concarray_length.
+ */
+extern Array concarray_to_array (Concarray ca);
+
+/**
+ * @brief Create a new columnar record container ADT instance.
+ *
+ * @param[in] nmemb The number of records.
+ * @param[in] ncolumns The number of columns.
+ * @param[in] sizes The size of each field, in bytes.
+ * @param[in] offsets The offset of each field inside a record, in bytes, as
+ * given by offsetof. If this is NULL the fields are packed one after the
+ * other.
+ *
+ * @retval new_colarray A pointer to the new columnar record container ADT
+ * instance.
+ *
+ * @warning The return value can also be NULL if some problem occurred.
+ */
+extern Colarray colarray_new (int nmemb, int ncolumns, size_t * sizes,
+			      size_t * offsets);
+
+/**
+ * @brief Delete the ADT instance of the columnar record container.
+ *
+ * @param[in] ca_ref The memory address of the variable containing the
+ * pointer to the columnar record container ADT instance.
+ */
+extern void colarray_delete (Colarray * ca_ref);
+
+/**
+ * @brief Get the number of records.
+ *
+ * @param[in] ca The pointer to a columnar record container ADT instance.
+ *
+ * @retval array_length(ca->column[0]) The number of records.
+ *
+ * @pre ca must not be NULL.
+ */
+extern int colarray_length (Colarray ca);
+
+/**
+ * @brief Get a column.
+ *
+ * @param[in] ca The pointer to a columnar record container ADT instance.
+ * @param[in] column The column number.
+ *
+ * @retval ca->column[column] The pointer to the array ADT instance of the
+ * column.
+ *
+ * @warning This function may return NULL if some problem occured.
+ *
+ * @note The length of the column must not be changed directly.
+ */
+extern Array colarray_column (Colarray ca, int column);
+
+/**
+ * @brief Store a record, scattering its fields across the columns.
+ *
+ * @param[in] ca The pointer to a columnar record container ADT instance.
+ * @param[in] index The index where to store the record.
+ * @param[in] record A memory address of the record to be stored.
+ *
+ * @retval true The record has been stored correctly.
+ * @retval false Some problem occurred.
+ */
+extern bool colarray_put (Colarray ca, int index, void *record);
+
+/**
+ * @brief Get a record, gathering its fields from the columns.
+ *
+ * @param[in] ca The pointer to a columnar record container ADT instance.
+ * @param[in] index The index of the record.
+ * @param[out] record A memory address where the record is copied.
+ *
+ * @retval true The record has been copied correctly.
+ * @retval false Some problem occurred.
+ */
+extern bool colarray_get (Colarray ca, int index, void *record);
+
+/**
+ * @brief Resize all the columns to a new specified length.
+ *
+ * @param[in] ca The pointer to a columnar record container ADT instance.
+ * @param[in] new_length The new number of records.
+ *
+ * @retval true Resize successful.
+ * @retval false Resize unsuccessful. The columns keep their old length.
+ */
+extern bool colarray_resize (Colarray ca, int new_length);
+
+/**
+ * @brief Append a record.
+ *
+ * @param[in] ca The pointer to a columnar record container ADT instance.
+ * @param[in] record A memory address of the record to be appended.
+ *
+ * @retval true Append successful.
+ * @retval false Append unsuccessful.
+ */
+extern bool colarray_append (Colarray ca, void *record);
+
+/**
+ * @brief Remove a record, shifting the following ones.
+ *
+ * @param[in] ca The pointer to a columnar record container ADT instance.
+ * @param[in] index The index of the record to be removed.
+ *
+ * @retval true Erase successful.
+ * @retval false Erase unsuccessful.
+ */
+extern bool colarray_erase (Colarray ca, int index);
+
+/**
+ * @brief Create a new bit array ADT instance with all the bits cleared.
+ *
+ * @param[in] nbits The number of bits.
+ *
+ * @retval new_bitarray A pointer to the new bit array ADT instance.
+ *
+ * @warning The return value can also be NULL if some problem occurred.
+ */
+extern Bitarray bitarray_new (int nbits);
+
+/**
+ * @brief Delete the ADT instance of the bit array.
+ *
+ * @param[in] b_ref The memory address of the variable containing the
+ * pointer to the bit array ADT instance.
+ */
+extern void bitarray_delete (Bitarray * b_ref);
+
+/**
+ * @brief Get the number of bits contained in the bit array.
+ *
+ * @param[in] b The pointer to a bit array ADT instance.
+ *
+ * @retval b->nbits The length of the bit array.
+ *
+ * @pre b must not be NULL.
+ */
+extern int bitarray_length (Bitarray b);
+
+/**
+ * @brief Set a bit.
+ *
+ * @param[in] b The pointer to a bit array ADT instance.
+ * @param[in] index The index of the bit.
+ *
+ * @retval true The bit has been set.
+ * @retval false The index is out of bounds.
+ */
+extern bool bitarray_set (Bitarray b, int index);
+
+/**
+ * @brief Clear a bit.
+ *
+ * @param[in] b The pointer to a bit array ADT instance.
+ * @param[in] index The index of the bit.
+ *
+ * @retval true The bit has been cleared.
+ * @retval false The index is out of bounds.
+ */
+extern bool bitarray_clear (Bitarray b, int index);
+
+/**
+ * @brief Test a bit.
+ *
+ * @param[in] b The pointer to a bit array ADT instance.
+ * @param[in] index The index of the bit.
+ *
+ * @retval true The bit is set.
+ * @retval false The bit is cleared or the index is out of bounds.
+ */
+extern bool bitarray_test (Bitarray b, int index);
+
+/**
+ * @brief Bitwise and of two bit arrays, stored in the first one.
+ *
+ * @param[in,out] b1 The pointer to the first bit array ADT instance.
+ * @param[in] b2 The pointer to the second bit array ADT instance.
+ *
+ * @retval true Operation successful.
+ * @retval false The two bit arrays have different lengths.
+ */
+extern bool bitarray_and (Bitarray b1, Bitarray b2);
+
+/**
+ * @brief Bitwise or of two bit arrays, stored in the first one.
+ *
+ * @param[in,out] b1 The pointer to the first bit array ADT instance.
+ * @param[in] b2 The pointer to the second bit array ADT instance.
+ *
+ * @retval true Operation successful.
+ * @retval false The two bit arrays have different lengths.
+ */
+extern bool bitarray_or (Bitarray b1, Bitarray b2);
+
+/**
+ * @brief Bitwise exclusive or of two bit arrays, stored in the first one.
+ *
+ * @param[in,out] b1 The pointer to the first bit array ADT instance.
+ * @param[in] b2 The pointer to the second bit array ADT instance.
+ *
+ * @retval true Operation successful.
+ * @retval false The two bit arrays have different lengths.
+ */
+extern bool bitarray_xor (Bitarray b1, Bitarray b2);
+
+/**
+ * @brief Clear in the first bit array the bits set in the second one.
+ *
+ * @param[in,out] b1 The pointer to the first bit array ADT instance.
+ * @param[in] b2 The pointer to the second bit array ADT instance.
+ *
+ * @retval true Operation successful.
+ * @retval false The two bit arrays have different lengths.
+ *
+ * @note The bulk operations use SSE2 or AVX2 as selected by array_simd.
+ */
+extern bool bitarray_andnot (Bitarray b1, Bitarray b2);
+
+/**
+ * @brief Count the bits that are set.
+ *
+ * @param[in] b The pointer to a bit array ADT instance.
+ *
+ * @retval count The number of bits set.
+ *
+ * @pre b must not be NULL.
+ */
+extern int bitarray_count (Bitarray b);
+
+/**
+ * @brief Count the bits that are set before the specified index.
+ *
+ * @param[in] b The pointer to a bit array ADT instance.
+ * @param[in] index The index where to stop counting. This can also be equal
+ * to the length of the bit array.
+ *
+ * @retval rank The number of bits set in [0, index).
+ * @retval -1 The index is out of bounds.
+ *
+ * @pre b must not be NULL.
+ *
+ * @note The rank directory gives the count up to the superblock of index,
+ * so at most BITARRAY_SUPERWORDS words are counted. The first query after a
+ * change of the bits rebuilds the directory in a single pass, so this is not
+ * safe to call from several threads at once.
+ */
+extern int bitarray_rank (Bitarray b, int index);
+
+/**
+ * @brief Find the first bit set starting from the specified index.
+ *
+ * @param[in] b The pointer to a bit array ADT instance.
+ * @param[in] index The index where to start searching.
+ *
+ * @retval next The index of the first bit set that is not before index.
+ * @retval -1 No bit is set from index onwards.
+ *
+ * @pre b must not be NULL.
+ */
+extern int bitarray_next (Bitarray b, int index);
+
+/**
+ * @brief Create a bit array from an array of bool.
+ *
+ * @param[in] a The pointer to an array ADT instance of bool.
+ *
+ * @retval b The pointer to the new bit array ADT instance.
+ *
+ * @warning This function may return NULL if some problem occured.
+ */
+extern Bitarray bitarray_from_array (Array a);
+
+/**
+ * @brief Create an array of bool from a bit array.
+ *
+ * @param[in] b The pointer to a bit array ADT instance.
+ *
+ * @retval a The pointer to the new array ADT instance of bool.
+ *
+ * @warning This function may return NULL if some problem occured.
+ */
+extern Array bitarray_to_array (Bitarray b);
+
+/**
+ * @brief Create a new empty compressed integer array ADT instance.
+ *
+ * @param[in] size The size of each element, either 4 or 8 bytes.
+ *
+ * @retval new_cintarray A pointer to the new compressed integer array ADT
+ * instance.
+ *
+ * @warning The return value can also be NULL if some problem occurred.
+ */
+extern Cintarray cintarray_new (size_t size);
+
+/**
+ * @brief Delete the ADT instance of the compressed integer array.
+ *
+ * @param[in] ca_ref The memory address of the variable containing the
+ * pointer to the compressed integer array ADT instance.
+ */
+extern void cintarray_delete (Cintarray * ca_ref);
+
+/**
+ * @brief Get the number of elements contained in the compressed integer
+ * array.
+ *
+ * @param[in] ca The pointer to a compressed integer array ADT instance.
+ *
+ * @retval ca->nmemb The length of the compressed integer array.
+ *
+ * @pre ca must not be NULL.
+ */
+extern int cintarray_length (Cintarray ca);
+
+/**
+ * @brief Get the memory used by the compressed integer array.
+ *
+ * @param[in] ca The pointer to a compressed integer array ADT instance.
+ *
+ * @retval fullsize The size in bytes of the encoded blocks, of their skip
+ * offsets and of the elements that are not encoded yet.
+ *
+ * @pre ca must not be NULL.
+ */
+extern size_t cintarray_fullsize (Cintarray ca);
+
+/**
+ * @brief Append (add on the tail) a new element on the compressed integer
+ * array.
+ *
+ * @param[in] ca The pointer to a compressed integer array ADT instance.
+ * @param[in] element A memory address of the integer to be inserted.
+ *
+ * @retval true Append successful.
+ * @retval false Append unsuccessful.
+ */
+extern bool cintarray_append (Cintarray ca, void *element);
+
+/**
+ * @brief Copy an element of the compressed integer array.
+ *
+ * @param[in] ca The pointer to a compressed integer array ADT instance.
+ * @param[in] index The index of the element.
+ * @param[out] element A memory address where the integer is copied.
+ *
+ * @retval true The element has been copied correctly.
+ * @retval false Some problem occurred.
+ *
+ * @note Only the block containing the element is decoded.
+ */
+extern bool cintarray_get (Cintarray ca, int index, void *element);
+
+/**
+ * @brief Create a compressed integer array from an array of integers.
+ *
+ * @param[in] a The pointer to an array ADT instance of 4 or 8 byte integers.
+ *
+ * @retval ca The pointer to the new compressed integer array ADT instance.
+ *
+ * @warning This function may return NULL if some problem occured.
+ */
+extern Cintarray cintarray_from_array (Array a);
+
+/**
+ * @brief Decode a compressed integer array into a new array.
+ *
+ * @param[in] ca The pointer to a compressed integer array ADT instance.
+ *
+ * @retval a The pointer to the new array ADT instance.
+ *
+ * @warning This function may return NULL if some problem occured.
+ */
+extern Array cintarray_to_array (Cintarray ca);
+
 #endif
@@ -0,0 +1,1013 @@
+/**
+ * @file salibc_bench.c
+ * @author Franco Masotti
+ * @date 28 Apr 2016
+ * @brief Benchmark file
+ */
+
+/*
+ * salibc_bench.c
+ *
+ * Copyright (C) 2016 frnmst (Franco Masotti) <franco.masotti@live.com>
+ *                                            <franco.masotti@student.unife.it>
+ *
+ * This file is part of salibc.
+ *
+ * salibc is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * salibc is distributed in the hope that it will be
+ * useful,but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with salibc.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief Needed by clock_gettime and by the POSIX threads.
+ */
+#define _POSIX_C_SOURCE 200112L
+
+#include "salibc.h"
+#include <pthread.h>
+#include <time.h>
+
+#if defined (SALIBC_BENCH) || DOXYGEN
+
+/**
+ * @brief if this flag is defined then the main function in this file is
+ * included.
+ */
+#define SALIBC_BENCH
+
+/**
+ * @brief Maximum number of producer threads.
+ */
+#define BENCH_MAX_PRODUCERS 32
+
+/**
+ * @brief Total number of elements appended in each append run.
+ */
+#define BENCH_APPEND_ELEMENTS (1 << 20)
+
+/**
+ * @brief Shared concurrent append array of the producer threads.
+ */
+static Concarray bench_concarray;
+
+/**
+ * @brief Shared array of the locked producer threads.
+ */
+static Array bench_array;
+
+/**
+ * @brief Lock that serializes the appends on bench_array.
+ */
+static pthread_mutex_t bench_array_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Number of elements appended by each producer of the current run.
+ */
+static int bench_producer_elements;
+
+/**
+ * @brief Number of elements of the array shared by the reader threads.
+ */
+#define BENCH_READ_ELEMENTS 1024
+
+/**
+ * @brief Total number of reads in each read run.
+ */
+#define BENCH_READS (1 << 22)
+
+/**
+ * @brief Lock that protects bench_array in the locked read run.
+ */
+static pthread_rwlock_t bench_array_rwlock = PTHREAD_RWLOCK_INITIALIZER;
+
+/**
+ * @brief Number of reads made by each reader of the current run.
+ */
+static int bench_reader_reads;
+
+/**
+ * @brief Tell the writer thread to stop.
+ */
+static bool bench_stop;
+
+/**
+ * @brief Time the writer thread waits between two resizes.
+ */
+static const struct timespec bench_writer_pause = { 0, 1000000 };
+
+/**
+ * @brief Keep the compiler from dropping the reads.
+ */
+static volatile int bench_sink;
+
+/**
+ * @brief Number of records of the scan run.
+ */
+#define BENCH_RECORDS (1 << 22)
+
+/**
+ * @brief Number of bits of the bit array run.
+ */
+#define BENCH_BITS (1 << 28)
+
+/**
+ * @brief Number of rank queries of the bit array run.
+ */
+#define BENCH_RANKS 1000000
+
+/**
+ * @brief Record type of the scan run.
+ */
+struct bench_record
+{
+  /**
+   * @brief The scanned field.
+   */
+  double x;
+  /**
+   * @brief A field that is not scanned.
+   */
+  double y;
+  /**
+   * @brief A field that is not scanned.
+   */
+  double z;
+  /**
+   * @brief A field that is not scanned.
+   */
+  long id;
+};
+
+/**
+ * @brief Get the current time.
+ *
+ * @retval seconds A monotonic time, in seconds.
+ */
+static double
+bench_now (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ((double) ts.tv_sec + (double) ts.tv_nsec * 1e-9);
+}
+
+/**
+ * @brief Append bench_producer_elements integers without locking.
+ *
+ * @param[in] arg Unused.
+ *
+ * @retval NULL Always.
+ */
+static void *
+bench_concarray_producer (void *arg)
+{
+  int i;
+
+  (void) arg;
+  for (i = 0; i < bench_producer_elements; i++)
+    concarray_append (bench_concarray, &i);
+
+  return NULL;
+}
+
+/**
+ * @brief Append bench_producer_elements integers behind a mutex.
+ *
+ * @param[in] arg Unused.
+ *
+ * @retval NULL Always.
+ */
+static void *
+bench_array_producer (void *arg)
+{
+  int i;
+
+  (void) arg;
+  for (i = 0; i < bench_producer_elements; i++)
+    {
+      pthread_mutex_lock (&bench_array_lock);
+      array_append (bench_array, &i);
+      pthread_mutex_unlock (&bench_array_lock);
+    }
+
+  return NULL;
+}
+
+/**
+ * @brief Read the shared array without locking.
+ *
+ * @param[in] arg Unused.
+ *
+ * @retval NULL Always.
+ */
+static void *
+bench_concurrent_reader (void *arg)
+{
+  int i, value, sum = 0;
+
+  (void) arg;
+  for (i = 0; i < bench_reader_reads; i++)
+    if (array_read (bench_array, i % BENCH_READ_ELEMENTS, &value))
+      sum += value;
+
+  bench_sink += sum;
+  return NULL;
+}
+
+/**
+ * @brief Read the shared array behind a reader-writer lock.
+ *
+ * @param[in] arg Unused.
+ *
+ * @retval NULL Always.
+ */
+static void *
+bench_locked_reader (void *arg)
+{
+  int i, sum = 0;
+  char *element;
+
+  (void) arg;
+  for (i = 0; i < bench_reader_reads; i++)
+    {
+      pthread_rwlock_rdlock (&bench_array_rwlock);
+      element = array_get (bench_array, i % BENCH_READ_ELEMENTS);
+      if (element != NULL)
+	sum += *((int *) element);
+      pthread_rwlock_unlock (&bench_array_rwlock);
+    }
+
+  bench_sink += sum;
+  return NULL;
+}
+
+/**
+ * @brief Resize the shared array back and forth until told to stop.
+ *
+ * The two lengths are far enough apart that every resize replaces the
+ * buffer. Without a lock, the retired buffers are reclaimed after each one.
+ *
+ * @param[in] arg The memory address of the lock to take, or NULL.
+ *
+ * @retval NULL Always.
+ */
+static void *
+bench_writer (void *arg)
+{
+  int i = 0;
+
+  while (!__atomic_load_n (&bench_stop, __ATOMIC_RELAXED))
+    {
+      if (arg != NULL)
+	pthread_rwlock_wrlock (arg);
+      array_resize (bench_array, i++ & 1 ? BENCH_READ_ELEMENTS :
+		    8 * BENCH_READ_ELEMENTS);
+      if (arg == NULL)
+	array_reclaim (bench_array);
+      else
+	pthread_rwlock_unlock (arg);
+      nanosleep (&bench_writer_pause, NULL);
+    }
+
+  return NULL;
+}
+
+/**
+ * @brief Run a producer function on the specified number of threads.
+ *
+ * @param[in] producer The producer function.
+ * @param[in] threads The number of threads.
+ *
+ * @retval seconds The elapsed time, in seconds.
+ */
+static double
+bench_producers (void *(*producer) (void *), int threads)
+{
+  int i;
+  double start;
+  pthread_t producers[BENCH_MAX_PRODUCERS];
+
+  bench_producer_elements = BENCH_APPEND_ELEMENTS / threads;
+  start = bench_now ();
+  for (i = 0; i < threads; i++)
+    pthread_create (&producers[i], NULL, producer, NULL);
+  for (i = 0; i < threads; i++)
+    pthread_join (producers[i], NULL);
+
+  return (bench_now () - start);
+}
+
+/**
+ * @brief Run a reader function on the specified number of threads while
+ * another thread resizes the shared array.
+ *
+ * @param[in] reader The reader function.
+ * @param[in] threads The number of threads.
+ * @param[in] locked true if the writer must take bench_array_rwlock.
+ *
+ * @retval seconds The elapsed time, in seconds.
+ */
+static double
+bench_readers (void *(*reader) (void *), int threads, bool locked)
+{
+  int i;
+  double start;
+  pthread_t writer, readers[BENCH_MAX_PRODUCERS];
+
+  bench_reader_reads = BENCH_READS / threads;
+  bench_stop = false;
+  pthread_create (&writer, NULL, bench_writer,
+		  locked ? &bench_array_rwlock : NULL);
+  start = bench_now ();
+  for (i = 0; i < threads; i++)
+    pthread_create (&readers[i], NULL, reader, NULL);
+  for (i = 0; i < threads; i++)
+    pthread_join (readers[i], NULL);
+  start = bench_now () - start;
+  __atomic_store_n (&bench_stop, true, __ATOMIC_RELAXED);
+  pthread_join (writer, NULL);
+
+  return start;
+}
+
+/**
+ * @brief Sum one field of BENCH_RECORDS records, stored both as an array of
+ * structs and as a columnar container.
+ */
+static void
+bench_scan (void)
+{
+  int i;
+  double start, t_aos, t_soa, sum_aos = 0, sum_soa = 0, *x;
+  size_t sizes[4] = { sizeof (double), sizeof (double), sizeof (double),
+    sizeof (long)
+  };
+  size_t offsets[4] = { offsetof (struct bench_record, x),
+    offsetof (struct bench_record, y), offsetof (struct bench_record, z),
+    offsetof (struct bench_record, id)
+  };
+  struct bench_record record = { 0, 0, 0, 0 }, *records;
+  Array aos;
+  Colarray soa;
+
+  aos = array_new (BENCH_RECORDS, sizeof (struct bench_record));
+  soa = colarray_new (BENCH_RECORDS, 4, sizes, offsets);
+  for (i = 0; i < BENCH_RECORDS; i++)
+    {
+      record.x = i;
+      array_put (aos, i, &record);
+      colarray_put (soa, i, &record);
+    }
+
+  start = bench_now ();
+  records = (struct bench_record *) array_pointer (aos);
+  for (i = 0; i < BENCH_RECORDS; i++)
+    sum_aos += records[i].x;
+  t_aos = bench_now () - start;
+
+  start = bench_now ();
+  x = (double *) array_pointer (colarray_column (soa, 0));
+  for (i = 0; i < BENCH_RECORDS; i++)
+    sum_soa += x[i];
+  t_soa = bench_now () - start;
+
+  printf ("\nScan of one double field of %d records (GB/s of field data)\n",
+	  BENCH_RECORDS);
+  printf ("%12s %12s\n", "aos", "colarray");
+  printf ("%12.2f %12.2f%s\n", BENCH_RECORDS * sizeof (double) / t_aos * 1e-9,
+	  BENCH_RECORDS * sizeof (double) / t_soa * 1e-9,
+	  sum_aos == sum_soa ? "" : " (mismatch)");
+
+  array_delete (&aos);
+  colarray_delete (&soa);
+}
+
+/**
+ * @brief Compress and decode an array of integers, at every instruction set
+ * level.
+ *
+ * @param[in] name The name of the data set.
+ * @param[in] a The pointer to an array ADT instance of integers.
+ */
+static void
+bench_cintarray (const char *name, Array a)
+{
+  int i, level;
+  double start, t_decode[ARRAY_AVX2 + 1], t_get;
+  uint64_t value;
+  bool equal = true;
+  Cintarray ca;
+  Array decoded;
+
+  ca = cintarray_from_array (a);
+
+  for (level = ARRAY_SCALAR; level <= ARRAY_AVX2; level++)
+    {
+      array_setsimd ((Arraysimd) level);
+      start = bench_now ();
+      decoded = cintarray_to_array (ca);
+      t_decode[level] = bench_now () - start;
+      equal = equal && array_equal (a, decoded);
+      array_delete (&decoded);
+    }
+
+  start = bench_now ();
+  for (i = 0; i < array_length (a); i += 97)
+    cintarray_get (ca, i, &value);
+  t_get = bench_now () - start;
+
+  printf ("%20s %8.2f %8.2f %8.2f %8.2f %10.2f%s\n", name,
+	  (double) array_fullsize (a) / cintarray_fullsize (ca),
+	  array_fullsize (a) / t_decode[ARRAY_SCALAR] * 1e-9,
+	  array_fullsize (a) / t_decode[ARRAY_SSE2] * 1e-9,
+	  array_fullsize (a) / t_decode[ARRAY_AVX2] * 1e-9,
+	  (array_length (a) / 97) / t_get * 1e-6, equal ? "" : " (mismatch)");
+
+  cintarray_delete (&ca);
+}
+
+/**
+ * @brief Number of elements of the hash index run.
+ */
+#define BENCH_INDEX_ELEMENTS (1 << 20)
+
+/**
+ * @brief Number of lookups made with a linear scan.
+ */
+#define BENCH_LINEAR_LOOKUPS 200
+
+/**
+ * @brief Build a hash index over random keys and compare its lookups with
+ * a linear scan.
+ *
+ * @param[in] size The size of the keys, in bytes.
+ */
+static void
+bench_index (size_t size)
+{
+  int i, found = 0;
+  double start, t_build, t_hash, t_linear;
+  unsigned char key[16];
+  size_t j;
+  Array a;
+
+  a = array_new (BENCH_INDEX_ELEMENTS, size);
+  for (i = 0; i < BENCH_INDEX_ELEMENTS; i++)
+    for (j = 0; j < size; j++)
+      array_get (a, i)[j] = (char) rand ();
+
+  start = bench_now ();
+  for (i = 0; i < BENCH_LINEAR_LOOKUPS; i++)
+    found +=
+      array_find (a, array_get (a, rand () % BENCH_INDEX_ELEMENTS)) >= 0;
+  t_linear = bench_now () - start;
+
+  start = bench_now ();
+  array_attachindex (a);
+  t_build = bench_now () - start;
+
+  start = bench_now ();
+  for (i = 0; i < BENCH_INDEX_ELEMENTS; i++)
+    {
+      memcpy (key, array_get (a, (int) ((unsigned int) i * 7919u
+					% BENCH_INDEX_ELEMENTS)), size);
+      found += array_find (a, key) >= 0;
+    }
+  t_hash = bench_now () - start;
+
+  printf ("%8zu %12.2f %12.1f %12.1f%s\n", size, t_build * 1e3,
+	  t_hash / BENCH_INDEX_ELEMENTS * 1e9,
+	  t_linear / BENCH_LINEAR_LOOKUPS * 1e9,
+	  found == BENCH_INDEX_ELEMENTS + BENCH_LINEAR_LOOKUPS ? "" :
+	  " (missing)");
+
+  array_delete (&a);
+}
+
+/**
+ * @brief Number of sorted runs of the k-way merge run.
+ */
+#define BENCH_RUNS 256
+
+/**
+ * @brief Number of elements of each sorted run.
+ */
+#define BENCH_RUN_ELEMENTS 4096
+
+/**
+ * @brief Compare two 32 bit unsigned integers.
+ *
+ * @param[in] e1 The memory address of the first integer.
+ * @param[in] e2 The memory address of the second integer.
+ *
+ * @retval <0 The first integer is smaller.
+ * @retval 0 The integers are equal.
+ * @retval >0 The first integer is greater.
+ */
+static int
+bench_cmp (const void *e1, const void *e2)
+{
+  return ((*((const uint32_t *) e1) > *((const uint32_t *) e2))
+	  - (*((const uint32_t *) e1) < *((const uint32_t *) e2)));
+}
+
+/**
+ * @brief Create a sorted set of 32 bit unsigned integers.
+ *
+ * @param[in] nmemb The number of elements.
+ * @param[in] gap The maximum gap between two consecutive elements.
+ *
+ * @retval a The pointer to the new array ADT instance.
+ */
+static Array
+bench_sortedset (int nmemb, int gap)
+{
+  int i;
+  uint32_t value = 0;
+  Array a = array_new (nmemb, sizeof (uint32_t));
+
+  for (i = 0; i < nmemb; i++)
+    {
+      value += 1 + rand () % gap;
+      array_put (a, i, &value);
+    }
+
+  return a;
+}
+
+/**
+ * @brief Merge sorted runs and intersect sorted sets.
+ */
+static void
+bench_sorted (void)
+{
+  int i, j;
+  uint32_t value;
+  double start, t_merge, t_chunks, t_simd, t_scalar, t_skewed, t_skewednull;
+  Array runs[BENCH_RUNS], a1, a2, small, result;
+
+  for (i = 0; i < BENCH_RUNS; i++)
+    runs[i] = bench_sortedset (BENCH_RUN_ELEMENTS, 1 << 20);
+  start = bench_now ();
+  result = array_mergek (runs, BENCH_RUNS, NULL);
+  t_merge = bench_now () - start;
+  array_delete (&result);
+
+  /*
+   * The runs take turns with chunks of 1000 consecutive values.
+   */
+  for (i = 0; i < BENCH_RUNS; i++)
+    for (j = 0; j < BENCH_RUN_ELEMENTS; j++)
+      {
+	value = (uint32_t) (j / 1000 * BENCH_RUNS * 1000 + i * 1000
+			    + j % 1000);
+	array_put (runs[i], j, &value);
+      }
+  start = bench_now ();
+  result = array_mergek (runs, BENCH_RUNS, NULL);
+  t_chunks = bench_now () - start;
+  array_delete (&result);
+  for (i = 0; i < BENCH_RUNS; i++)
+    array_delete (&runs[i]);
+
+  a1 = bench_sortedset (BENCH_RECORDS, 4);
+  a2 = bench_sortedset (BENCH_RECORDS, 4);
+  small = bench_sortedset (BENCH_RECORDS / 1024, 4096);
+  start = bench_now ();
+  result = array_intersect (a1, a2, NULL);
+  t_simd = bench_now () - start;
+  array_delete (&result);
+  start = bench_now ();
+  result = array_intersect (a1, a2, bench_cmp);
+  t_scalar = bench_now () - start;
+  array_delete (&result);
+  start = bench_now ();
+  result = array_intersect (small, a1, bench_cmp);
+  t_skewed = bench_now () - start;
+  array_delete (&result);
+  start = bench_now ();
+  result = array_intersect (small, a1, NULL);
+  t_skewednull = bench_now () - start;
+  array_delete (&result);
+
+  printf ("\nSorted arrays (Melements/s)\n");
+  printf ("%20s %12.2f\n", "mergek 256 runs",
+	  BENCH_RUNS * BENCH_RUN_ELEMENTS / t_merge * 1e-6);
+  printf ("%20s %12.2f\n", "mergek in chunks",
+	  BENCH_RUNS * BENCH_RUN_ELEMENTS / t_chunks * 1e-6);
+  printf ("%20s %12.2f\n", "intersect sse2",
+	  2.0 * BENCH_RECORDS / t_simd * 1e-6);
+  printf ("%20s %12.2f\n", "intersect scalar",
+	  2.0 * BENCH_RECORDS / t_scalar * 1e-6);
+  printf ("%20s %12.2f\n", "intersect 1:1024",
+	  (BENCH_RECORDS + BENCH_RECORDS / 1024) / t_skewed * 1e-6);
+  printf ("%20s %12.2f\n", "1:1024 NULL cmp",
+	  (BENCH_RECORDS + BENCH_RECORDS / 1024) / t_skewednull * 1e-6);
+
+  array_delete (&a1);
+  array_delete (&a2);
+  array_delete (&small);
+}
+
+/**
+ * @brief Time the bulk operations and the rank queries of a bit array.
+ */
+static void
+bench_bitarray (void)
+{
+  int i, level, rank = 0;
+  double start, t;
+  Bitarray b1, b2;
+
+  b1 = bitarray_new (BENCH_BITS);
+  b2 = bitarray_new (BENCH_BITS);
+  for (i = 0; i < BENCH_BITS / 8; i++)
+    {
+      bitarray_set (b1, rand () % BENCH_BITS);
+      bitarray_set (b2, rand () % BENCH_BITS);
+    }
+
+  printf ("\nBit array of %d bits\n", BENCH_BITS);
+  printf ("%12s %12s %12s %12s\n", "operation", "scalar", "sse2", "avx2");
+  printf ("%12s", "and GB/s");
+  for (level = ARRAY_SCALAR; level <= ARRAY_AVX2; level++)
+    {
+      array_setsimd ((Arraysimd) level);
+      start = bench_now ();
+      bitarray_and (b1, b2);
+      t = bench_now () - start;
+      printf (" %12.2f", 2.0 * BENCH_BITS / 8 / t * 1e-9);
+    }
+  printf ("\n");
+  array_setsimd (ARRAY_AVX2);
+
+  bitarray_or (b1, b2);
+  start = bench_now ();
+  rank += bitarray_rank (b1, 0);
+  printf ("%12s %12.2f\n", "directory ms", (bench_now () - start) * 1e3);
+  start = bench_now ();
+  for (i = 0; i < BENCH_RANKS; i++)
+    rank += bitarray_rank (b1, rand () % BENCH_BITS);
+  t = bench_now () - start;
+  printf ("%12s %12.2f\n", "rank ns", t / BENCH_RANKS * 1e9);
+  bench_sink += rank;
+
+  bitarray_delete (&b1);
+  bitarray_delete (&b2);
+}
+
+/**
+ * @brief Time the reorder of an array by a random permutation.
+ *
+ * @param[in] size The size of the elements.
+ * @param[in] perm The permutation.
+ */
+static void
+bench_reorder (size_t size, Array perm)
+{
+  int i;
+  double start, t_naive, t_gather, t_scatter, t_permute;
+  Array a, b;
+
+  a = array_new (array_length (perm), size);
+  b = array_new (array_length (perm), size);
+  for (i = 0; i < array_length (a); i++)
+    memset (array_get (a, i), i, size);
+
+  start = bench_now ();
+  for (i = 0; i < array_length (perm); i++)
+    array_put (b, i, array_get (a, *((int *) array_get (perm, i))));
+  t_naive = bench_now () - start;
+  start = bench_now ();
+  array_gather (b, a, perm);
+  t_gather = bench_now () - start;
+  start = bench_now ();
+  array_scatter (b, a, perm);
+  t_scatter = bench_now () - start;
+  start = bench_now ();
+  array_permuteinplace (a, perm);
+  t_permute = bench_now () - start;
+
+  printf ("%8zu %12.2f %12.2f %12.2f %12.2f\n", size,
+	  array_length (perm) / t_naive * 1e-6,
+	  array_length (perm) / t_gather * 1e-6,
+	  array_length (perm) / t_scatter * 1e-6,
+	  array_length (perm) / t_permute * 1e-6);
+
+  array_delete (&a);
+  array_delete (&b);
+}
+
+/**
+ * @brief Read an element of a numeric type as a double.
+ *
+ * @param[in] type The type of the element.
+ * @param[in] element The memory address of the element.
+ *
+ * @retval value The value of the element.
+ */
+static double
+bench_load (Arraytype type, const char *element)
+{
+  switch (type)
+    {
+    case ARRAY_INT32:
+      return *((const int32_t *) element);
+    case ARRAY_INT64:
+      return (double) *((const int64_t *) element);
+    case ARRAY_FLOAT:
+      return *((const float *) element);
+    default:
+      return *((const double *) element);
+    }
+}
+
+/**
+ * @brief Write a double into an element of a numeric type.
+ *
+ * @param[in] type The type of the element.
+ * @param[out] element The memory address of the element.
+ * @param[in] value The value.
+ */
+static void
+bench_store (Arraytype type, char *element, double value)
+{
+  switch (type)
+    {
+    case ARRAY_INT32:
+      *((int32_t *) element) = (int32_t) value;
+      break;
+    case ARRAY_INT64:
+      *((int64_t *) element) = (int64_t) value;
+      break;
+    case ARRAY_FLOAT:
+      *((float *) element) = (float) value;
+      break;
+    default:
+      *((double *) element) = value;
+      break;
+    }
+}
+
+/**
+ * @brief Run a numeric kernel with an array_get loop, as user code would
+ * without the library kernels.
+ *
+ * @param[in] kernel The kernel number, as in bench_kernels.
+ * @param[in] type The type of the elements.
+ * @param[in] x The first operand.
+ * @param[in,out] y The second operand, changed by axpy.
+ * @param[in,out] copy The operand of the prefix sum.
+ */
+static void
+bench_naive (int kernel, Arraytype type, Array x, Array y, Array copy)
+{
+  int i, argmin = 0, argmax = 0;
+  double value, result = 0;
+
+  for (i = 0; i < array_length (x); i++)
+    switch (kernel)
+      {
+      case 0:
+	result += bench_load (type, array_get (x, i));
+	break;
+      case 1:
+	value = bench_load (type, array_get (x, i));
+	if (value < bench_load (type, array_get (x, argmin)))
+	  argmin = i;
+	if (value > bench_load (type, array_get (x, argmax)))
+	  argmax = i;
+	break;
+      case 2:
+	result += bench_load (type, array_get (x, i))
+	  * bench_load (type, array_get (y, i));
+	break;
+      case 3:
+	bench_store (type, array_get (y, i),
+		     bench_load (type, array_get (y, i))
+		     + 3 * bench_load (type, array_get (x, i)));
+	break;
+      default:
+	result += bench_load (type, array_get (copy, i));
+	bench_store (type, array_get (copy, i), result);
+	break;
+      }
+
+  bench_sink += (int) result + argmin + argmax;
+}
+
+/**
+ * @brief Time the numeric kernels at every instruction set level.
+ *
+ * @param[in] name The name of the element type.
+ * @param[in] type The type of the elements.
+ * @param[in] size The size of the elements.
+ */
+static void
+bench_kernels (const char *name, Arraytype type, size_t size)
+{
+  static const char *kernels[] = { "sum", "minmax", "dot", "axpy",
+    "prefixsum"
+  };
+  int i, kernel, level, argmin, argmax;
+  int32_t value32;
+  int64_t value64;
+  float valuef;
+  double valued, result, start, t, bytes;
+  void *values[] = { &value32, &value64, &valuef, &valued };
+  Array x, y, copy;
+
+  x = array_new (BENCH_RECORDS, size);
+  y = array_new (BENCH_RECORDS, size);
+  for (i = 0; i < BENCH_RECORDS; i++)
+    {
+      value32 = rand () % 100 - 50;
+      value64 = value32;
+      valuef = (float) value32;
+      valued = value32;
+      array_put (x, i, values[type]);
+      array_put (y, i, values[type]);
+    }
+
+  printf ("\nNumeric kernels on %d %s (GB/s)\n", BENCH_RECORDS, name);
+  printf ("%12s %12s %12s %12s %12s\n", "kernel", "array_get", "scalar",
+	  "sse2", "avx2");
+  for (kernel = 0; kernel < 5; kernel++)
+    {
+      printf ("%12s", kernels[kernel]);
+      copy = array_copy (x);
+      bytes = (double) array_fullsize (x)
+	* (kernel == 2 || kernel == 3 ? 2 : 1);
+      start = bench_now ();
+      bench_naive (kernel, type, x, y, copy);
+      t = bench_now () - start;
+      array_delete (&copy);
+      printf (" %12.2f", bytes / t * 1e-9);
+      for (level = ARRAY_SCALAR; level <= ARRAY_AVX2; level++)
+	{
+	  array_setsimd ((Arraysimd) level);
+	  copy = array_copy (x);
+	  bytes = (double) array_fullsize (x);
+	  start = bench_now ();
+	  switch (kernel)
+	    {
+	    case 0:
+	      array_sum (x, type, &result);
+	      break;
+	    case 1:
+	      array_minmax (x, type, &argmin, &argmax);
+	      break;
+	    case 2:
+	      array_dot (x, y, type, &result);
+	      bytes *= 2;
+	      break;
+	    case 3:
+	      array_axpy (y, x, type, values[type]);
+	      bytes *= 2;
+	      break;
+	    default:
+	      array_prefixsum (copy, type, true);
+	      break;
+	    }
+	  t = bench_now () - start;
+	  array_delete (&copy);
+	  printf (" %12.2f", bytes / t * 1e-9);
+	}
+      printf ("\n");
+    }
+  array_setsimd (ARRAY_AVX2);
+
+  array_delete (&x);
+  array_delete (&y);
+}
+
+int
+main (void)
+{
+  int threads;
+  int i;
+  double t_locked, t_lockfree, t_argsort;
+  uint32_t value32;
+  uint64_t value64;
+  Array sorted, perm;
+
+  printf ("Append of %d ints (Mappends/s)\n", BENCH_APPEND_ELEMENTS);
+  printf ("%8s %12s %12s\n", "threads", "mutex", "concarray");
+  for (threads = 1; threads <= BENCH_MAX_PRODUCERS; threads *= 2)
+    {
+      bench_array = array_new (0, sizeof (int));
+      t_locked = bench_producers (bench_array_producer, threads);
+      array_delete (&bench_array);
+
+      bench_concarray = concarray_new (sizeof (int));
+      t_lockfree = bench_producers (bench_concarray_producer, threads);
+      concarray_delete (&bench_concarray);
+
+      printf ("%8d %12.2f %12.2f\n", threads,
+	      BENCH_APPEND_ELEMENTS / t_locked * 1e-6,
+	      BENCH_APPEND_ELEMENTS / t_lockfree * 1e-6);
+    }
+
+
+  printf ("\nRead of %d ints during resizes (Mreads/s)\n", BENCH_READS);
+  printf ("%8s %12s %12s\n", "threads", "rwlock", "array_read");
+  for (threads = 1; threads <= BENCH_MAX_PRODUCERS; threads *= 2)
+    {
+      bench_array = array_new (BENCH_READ_ELEMENTS, sizeof (int));
+      t_locked = bench_readers (bench_locked_reader, threads, true);
+      array_setconcurrent (bench_array);
+      t_lockfree = bench_readers (bench_concurrent_reader, threads, false);
+      array_delete (&bench_array);
+
+      printf ("%8d %12.2f %12.2f\n", threads, BENCH_READS / t_locked * 1e-6,
+	      BENCH_READS / t_lockfree * 1e-6);
+    }
+
+
+  bench_scan ();
+
+  printf ("\nCompressed integer arrays of %d elements (decode in GB/s)\n",
+	  BENCH_RECORDS);
+  printf ("%20s %8s %8s %8s %8s %10s\n", "data", "ratio", "scalar", "sse2",
+	  "avx2", "Mgets/s");
+  sorted = array_new (BENCH_RECORDS, sizeof (uint64_t));
+  for (i = 0, value64 = 0; i < BENCH_RECORDS; i++)
+    {
+      value64 += rand () % 64;
+      array_put (sorted, i, &value64);
+    }
+  bench_cintarray ("sorted uint64", sorted);
+  for (i = 0, value64 = 0; i < BENCH_RECORDS; i++)
+    {
+      value64 += rand () % 64 + (rand () % 100 == 0 ? UINT64_C (1) << 40 : 0);
+      array_put (sorted, i, &value64);
+    }
+  bench_cintarray ("with 1% outliers", sorted);
+  array_delete (&sorted);
+  sorted = array_new (BENCH_RECORDS, sizeof (uint32_t));
+  for (i = 0, value32 = 1 << 30; i < BENCH_RECORDS; i++)
+    {
+      value32 += rand () % 9 - 4;
+      array_put (sorted, i, &value32);
+    }
+  bench_cintarray ("slow uint32", sorted);
+  array_delete (&sorted);
+  sorted = array_new (BENCH_RECORDS, sizeof (int32_t));
+  for (i = 0; i < BENCH_RECORDS; i++)
+    {
+      value32 = (uint32_t) (i % 4 - 2);
+      array_put (sorted, i, &value32);
+    }
+  bench_cintarray ("int32 around zero", sorted);
+  array_delete (&sorted);
+
+  bench_bitarray ();
+
+  printf ("\nHash index over %d random keys\n", BENCH_INDEX_ELEMENTS);
+  printf ("%8s %12s %12s %12s\n", "size", "build ms", "hash ns",
+	  "linear ns");
+  bench_index (sizeof (uint32_t));
+  bench_index (sizeof (uint64_t));
+  bench_index (2 * sizeof (uint64_t));
+
+  bench_sorted ();
+
+  bench_kernels ("int32", ARRAY_INT32, sizeof (int32_t));
+  bench_kernels ("int64", ARRAY_INT64, sizeof (int64_t));
+  bench_kernels ("float", ARRAY_FLOAT, sizeof (float));
+  bench_kernels ("double", ARRAY_DOUBLE, sizeof (double));
+
+  sorted = array_new (BENCH_RECORDS, sizeof (uint32_t));
+  for (i = 0; i < BENCH_RECORDS; i++)
+    {
+      value32 = (uint32_t) rand ();
+      array_put (sorted, i, &value32);
+    }
+  t_argsort = bench_now ();
+  perm = array_argsort (sorted, NULL);
+  t_argsort = bench_now () - t_argsort;
+  array_delete (&sorted);
+  printf ("\nReorder of %d elements by a random permutation (Melements/s)\n",
+	  BENCH_RECORDS);
+  printf ("argsort: %.2f Melements/s\n", BENCH_RECORDS / t_argsort * 1e-6);
+  printf ("%8s %12s %12s %12s %12s\n", "size", "get/put", "gather",
+	  "scatter", "permute");
+  bench_reorder (sizeof (uint32_t), perm);
+  bench_reorder (sizeof (uint64_t), perm);
+  bench_reorder (2 * sizeof (uint64_t), perm);
+  array_delete (&perm);
+
+  return 0;
+}
+
+#endif
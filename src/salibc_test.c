@@ -27,7 +27,14 @@
  * along with salibc.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/**
+ * @brief Needed by the POSIX threads used in the concurrency tests.
+ */
+#define _POSIX_C_SOURCE 200112L
+
 #include "salibc.h"
+#include <math.h>
+#include <pthread.h>
 
 #if defined (SALIBC_TEST) || DOXYGEN
 
@@ -37,6 +44,267 @@
  */
 #define SALIBC_TEST
 
+/**
+ * @brief Number of producer threads of the concurrent append test.
+ */
+#define TEST_PRODUCERS 8
+
+/**
+ * @brief Number of elements appended by each producer thread.
+ */
+#define TEST_PRODUCER_ELEMENTS 10000
+
+/**
+ * @brief Shared concurrent append array of the producer threads.
+ */
+static Concarray test_concarray;
+
+/**
+ * @brief Number of reader threads of the concurrent read test.
+ */
+#define TEST_READERS 4
+
+/**
+ * @brief Number of resizes made by the writer of the concurrent read test.
+ */
+#define TEST_RESIZES 500
+
+/**
+ * @brief Shared array of the reader threads.
+ */
+static Array test_shared;
+
+/**
+ * @brief Tell the reader threads to stop.
+ */
+static bool test_stop;
+
+/**
+ * @brief Number of inconsistent reads.
+ */
+static int test_torn;
+
+/**
+ * @brief Read the shared array until told to stop.
+ *
+ * @param[in] arg Unused.
+ *
+ * @retval NULL Always.
+ *
+ * Every element is either zero or equal to its index.
+ */
+static void *
+test_reader (void *arg)
+{
+  int i, value;
+
+  (void) arg;
+  while (!__atomic_load_n (&test_stop, __ATOMIC_RELAXED))
+    for (i = 0; i < array_readlength (test_shared); i++)
+      if (array_read (test_shared, i, &value) && value != 0 && value != i)
+	__atomic_fetch_add (&test_torn, 1, __ATOMIC_RELAXED);
+
+  return NULL;
+}
+
+/**
+ * @brief Record type of the columnar container test.
+ */
+struct test_record
+{
+  /**
+   * @brief A character field.
+   */
+  char c;
+  /**
+   * @brief A floating point field.
+   */
+  double d;
+};
+
+/**
+ * @brief Check that a compressed integer array decodes the same at every
+ * instruction set level.
+ *
+ * @param[in] a The integers to be compressed.
+ *
+ * @retval mismatches The number of decoded arrays and elements that differ
+ * from the original ones.
+ */
+static int
+test_cintarray (Array a)
+{
+  int i, level, mismatches = 0;
+  uint64_t value = 0;
+  Cintarray ca;
+  Array decoded;
+
+  ca = cintarray_from_array (a);
+  for (level = ARRAY_SCALAR; level <= ARRAY_AVX2; level++)
+    {
+      array_setsimd ((Arraysimd) level);
+      decoded = cintarray_to_array (ca);
+      if (!array_equal (a, decoded))
+	mismatches++;
+      array_delete (&decoded);
+      for (i = 0; i < array_length (a); i++)
+	if (!cintarray_get (ca, i, &value)
+	    || memcmp (&value, array_get (a, i), array_size (a)) != 0)
+	  mismatches++;
+    }
+  array_setsimd (ARRAY_AVX2);
+  cintarray_delete (&ca);
+
+  return mismatches;
+}
+
+/**
+ * @brief Number of elements of the numeric kernel arrays.
+ */
+#define TEST_KERNEL_ELEMENTS 1003
+
+/**
+ * @brief Run the numeric kernels at every instruction set level.
+ *
+ * @param[in] type The type of the elements.
+ * @param[in] x The first operand.
+ * @param[in] y The second operand.
+ *
+ * @retval mismatches The number of results that differ from the scalar
+ * ones.
+ */
+static int
+test_kernels (Arraytype type, Array x, Array y)
+{
+  int level, mismatches = 0, argmin[3], argmax[3];
+  int32_t alpha32 = 3;
+  int64_t alpha64 = 3;
+  float alphaf = 3;
+  double alphad = 3, sum[3], dot[3];
+  void *alpha[] = { &alpha32, &alpha64, &alphaf, &alphad };
+  Array prefix[3], axpy[3];
+
+  for (level = ARRAY_SCALAR; level <= ARRAY_AVX2; level++)
+    {
+      array_setsimd ((Arraysimd) level);
+      array_sum (x, type, &sum[level]);
+      array_minmax (x, type, &argmin[level], &argmax[level]);
+      array_dot (x, y, type, &dot[level]);
+      prefix[level] = array_copy (x);
+      array_prefixsum (prefix[level], type, true);
+      axpy[level] = array_copy (y);
+      array_axpy (axpy[level], x, type, alpha[type]);
+    }
+  array_setsimd (ARRAY_AVX2);
+
+  for (level = ARRAY_SSE2; level <= ARRAY_AVX2; level++)
+    mismatches += (memcmp (&sum[level], &sum[0], sizeof (double)) != 0)
+      + (argmin[level] != argmin[0]) + (argmax[level] != argmax[0])
+      + (memcmp (&dot[level], &dot[0], sizeof (double)) != 0)
+      + !array_equal (prefix[level], prefix[0])
+      + !array_equal (axpy[level], axpy[0]);
+  for (level = ARRAY_SCALAR; level <= ARRAY_AVX2; level++)
+    {
+      array_delete (&prefix[level]);
+      array_delete (&axpy[level]);
+    }
+
+  return mismatches;
+}
+
+/**
+ * @brief Tell if an integer is odd.
+ *
+ * @param[in] element The memory address of the integer.
+ * @param[in] ctx Unused.
+ *
+ * @retval true The integer is odd.
+ * @retval false The integer is even.
+ */
+static bool
+test_odd (void *element, void *ctx)
+{
+  (void) ctx;
+  return ((*((int *) element) % 2) != 0);
+}
+
+/**
+ * @brief Compare two integers.
+ *
+ * @param[in] e1 The memory address of the first integer.
+ * @param[in] e2 The memory address of the second integer.
+ *
+ * @retval <0 The first integer is smaller.
+ * @retval 0 The integers are equal.
+ * @retval >0 The first integer is greater.
+ */
+static int
+test_cmp (const void *e1, const void *e2)
+{
+  return ((*((const int *) e1) > *((const int *) e2))
+	  - (*((const int *) e1) < *((const int *) e2)));
+}
+
+/**
+ * @brief Compare two integers by their tens only.
+ *
+ * @param[in] e1 The memory address of the first integer.
+ * @param[in] e2 The memory address of the second integer.
+ *
+ * @retval <0 The first integer has fewer tens.
+ * @retval 0 The integers have the same tens.
+ * @retval >0 The first integer has more tens.
+ */
+static int
+test_cmptens (const void *e1, const void *e2)
+{
+  int x = *((const int *) e1) / 10, y = *((const int *) e2) / 10;
+
+  return ((x > y) - (x < y));
+}
+
+/**
+ * @brief Check if an array of integers is sorted.
+ *
+ * @param[in] a The pointer to an array ADT instance of integers.
+ *
+ * @retval true The array is sorted.
+ * @retval false The array is not sorted.
+ */
+static bool
+test_sorted (Array a)
+{
+  int i;
+
+  for (i = 1; i < array_length (a); i++)
+    if (test_cmp (array_get (a, i - 1), array_get (a, i)) > 0)
+      return false;
+
+  return true;
+}
+
+/**
+ * @brief Append TEST_PRODUCER_ELEMENTS distinct integers.
+ *
+ * @param[in] arg The memory address of the producer number.
+ *
+ * @retval NULL Always.
+ */
+static void *
+test_producer (void *arg)
+{
+  int i, value;
+
+  for (i = 0; i < TEST_PRODUCER_ELEMENTS; i++)
+    {
+      value = *((int *) arg) * TEST_PRODUCER_ELEMENTS + i;
+      if (!concarray_append (test_concarray, &value))
+	printf ("Concurrent append failed.\n");
+    }
+
+  return NULL;
+}
+
 /**
  * @note Use:
  * const MYVARIABLE = value
@@ -50,8 +318,27 @@ int
 main (void)
 {
 
-  int i;
-  Array arr0, arr1, arr2, arr3, arr4, arr5;
+  int i, j, duplicates = 0, ids[TEST_PRODUCERS];
+  bool flag = true;
+  pthread_t producers[TEST_PRODUCERS], readers[TEST_READERS];
+  size_t record_sizes[2] = { sizeof (char), sizeof (double) };
+  size_t record_offsets[2] = { offsetof (struct test_record, c),
+    offsetof (struct test_record, d)
+  };
+  struct test_record record;
+  Colarray col0;
+  Bitarray bit0, bit1;
+  Cintarray cint0;
+  uint64_t walk = 0, seed = 88172645463325252;
+  int mismatches;
+  Array sets[3], arr8;
+  Array kernels[4];
+  int argmin, argmax;
+  int32_t value32;
+  int64_t value64;
+  float valuef;
+  double valued;
+  Array arr0, arr1, arr2, arr3, arr4, arr5, arr6, arr7;
   char a = 'f';
   int b = 421;
   double c = 3223.554;
@@ -107,6 +394,432 @@ main (void)
 	    *((long double *) array_get (arr4, 1)),
 	    *((long double *) array_get (arr4, 2)));
 
+  test_concarray = concarray_new (sizeof (int));
+  for (i = 0; i < TEST_PRODUCERS; i++)
+    {
+      ids[i] = i;
+      pthread_create (&producers[i], NULL, test_producer, &ids[i]);
+    }
+  for (i = 0; i < TEST_PRODUCERS; i++)
+    pthread_join (producers[i], NULL);
+
+  /*
+   * Every value must have been appended exactly once.
+   */
+  arr6 = concarray_to_array (test_concarray);
+  arr7 = array_new (TEST_PRODUCERS * TEST_PRODUCER_ELEMENTS, sizeof (bool));
+  for (i = 0; i < array_length (arr6); i++)
+    {
+      j = *((int *) array_get (arr6, i));
+      if (*((bool *) array_get (arr7, j)))
+	duplicates++;
+      array_put (arr7, j, &flag);
+    }
+  printf ("Concurrent append: %d elements, %d duplicates\n",
+	  array_length (arr6), duplicates);
+  concarray_delete (&test_concarray);
+  array_delete (&arr6);
+  array_delete (&arr7);
+
+  arr6 = array_new (0, sizeof (int));
+  for (i = 0; i < 10; i++)
+    array_insert (arr6, 0, &i);
+  array_insertrange (arr6, 5, ids, 3);
+  array_erase (arr6, 0);
+  array_eraserange (arr6, 0, 2);
+  for (i = 0; i < array_length (arr6); i++)
+    printf ("%d ", *((int *) array_get (arr6, i)));
+  printf ("\n");
+  array_removeif (arr6, test_odd, NULL);
+  for (i = 0; i < array_length (arr6); i++)
+    printf ("%d ", *((int *) array_get (arr6, i)));
+  printf ("\n");
+  array_resize (arr6, array_length (arr6) + 3);
+  array_unique (arr6, NULL);
+  for (i = 0; i < array_length (arr6); i++)
+    printf ("%d ", *((int *) array_get (arr6, i)));
+  printf ("\n");
+  array_delete (&arr6);
+
+  col0 = colarray_new (0, 2, record_sizes, record_offsets);
+  for (i = 0; i < 5; i++)
+    {
+      record.c = (char) ('a' + i);
+      record.d = i * 1.5;
+      colarray_append (col0, &record);
+    }
+  colarray_erase (col0, 1);
+  for (i = 0; i < colarray_length (col0); i++)
+    {
+      colarray_get (col0, i, &record);
+      printf ("%c %f %f\n", record.c, record.d,
+	      *((double *) array_get (colarray_column (col0, 1), i)));
+    }
+  colarray_resize (col0, 2);
+  colarray_get (col0, 1, &record);
+  printf ("Columns after shrink: %d %d records, last %c %f\n",
+	  array_length (colarray_column (col0, 0)),
+	  array_length (colarray_column (col0, 1)), record.c, record.d);
+  colarray_delete (&col0);
+
+  bit0 = bitarray_new (200);
+  bit1 = bitarray_new (200);
+  for (i = 0; i < 200; i += 3)
+    bitarray_set (bit0, i);
+  for (i = 0; i < 200; i += 2)
+    bitarray_set (bit1, i);
+  bitarray_clear (bit0, 0);
+  bitarray_and (bit0, bit1);
+  printf ("Bits set: %d, rank(100): %d, next(7): %d, next(199): %d\n",
+	  bitarray_count (bit0), bitarray_rank (bit0, 100),
+	  bitarray_next (bit0, 7), bitarray_next (bit0, 199));
+  arr6 = bitarray_to_array (bit0);
+  bitarray_delete (&bit1);
+  bit1 = bitarray_from_array (arr6);
+  bitarray_xor (bit1, bit0);
+  printf ("Bits set after round trip xor: %d\n", bitarray_count (bit1));
+  array_delete (&arr6);
+  bitarray_delete (&bit0);
+  bitarray_delete (&bit1);
+  bit0 = bitarray_new (INT_MAX);
+  bitarray_set (bit0, INT_MAX - 1);
+  printf ("Bit array of INT_MAX bits: %d set, last %d\n",
+	  bitarray_count (bit0), bitarray_test (bit0, INT_MAX - 1));
+  bitarray_delete (&bit0);
+  bit0 = bitarray_new (5000);
+  bit1 = bitarray_new (5000);
+  for (i = 0, j = 0, mismatches = 0; i < 5000; i++)
+    {
+      if (bitarray_rank (bit0, i) != j)
+	mismatches++;
+      if ((i * 7919) % 3 == 0)
+	{
+	  bitarray_set (bit0, i);
+	  j++;
+	}
+      if ((i * 7919) % 5 == 0)
+	bitarray_set (bit1, i);
+    }
+  for (i = ARRAY_SCALAR; i <= ARRAY_AVX2; i++)
+    {
+      array_setsimd ((Arraysimd) i);
+      arr6 = bitarray_to_array (bit0);
+      bitarray_delete (&bit0);
+      bit0 = bitarray_from_array (arr6);
+      array_delete (&arr6);
+      bitarray_andnot (bit0, bit1);
+      bitarray_or (bit0, bit1);
+      bitarray_xor (bit0, bit1);
+      bitarray_or (bit0, bit1);
+      bitarray_and (bit0, bit1);
+      if (bitarray_count (bit0) != bitarray_count (bit1)
+	  || bitarray_rank (bit0, 4321) != bitarray_rank (bit1, 4321))
+	mismatches++;
+    }
+  array_setsimd (ARRAY_AVX2);
+  printf ("Bit rank and bulk operations: %d mismatches\n", mismatches);
+  bitarray_delete (&bit0);
+  bitarray_delete (&bit1);
+
+  arr6 = array_new (1000, sizeof (uint64_t));
+  for (i = 0; i < array_length (arr6); i++)
+    {
+      walk += (uint64_t) (i % 7) - 3 + (i == 500 ? UINT64_C (1) << 63 : 0);
+      array_put (arr6, i, &walk);
+    }
+  cint0 = cintarray_from_array (arr6);
+  arr7 = cintarray_to_array (cint0);
+  cintarray_get (cint0, 777, &walk);
+  printf ("Compressed %d integers from %zu to %zu bytes, %s, %s\n",
+	  cintarray_length (cint0), array_fullsize (arr6),
+	  cintarray_fullsize (cint0),
+	  array_equal (arr6, arr7) ? "equal" : "different",
+	  walk == *((uint64_t *) array_get (arr6, 777)) ? "ok" : "failed");
+  array_delete (&arr6);
+  array_delete (&arr7);
+  cintarray_delete (&cint0);
+
+  arr6 = array_new (1000, sizeof (int32_t));
+  for (i = 0; i < array_length (arr6); i++)
+    {
+      value32 = i == 500 ? INT32_MIN : i % 4 - 2;
+      array_put (arr6, i, &value32);
+    }
+  cint0 = cintarray_from_array (arr6);
+  arr7 = cintarray_to_array (cint0);
+  printf ("Compressed %d signed integers from %zu to %zu bytes, %s\n",
+	  cintarray_length (cint0), array_fullsize (arr6),
+	  cintarray_fullsize (cint0),
+	  array_equal (arr6, arr7) ? "equal" : "different");
+  array_delete (&arr6);
+  array_delete (&arr7);
+  cintarray_delete (&cint0);
+
+  /*
+   * Block j gets differences of about j bits, and every 61st one is an
+   * outlier that becomes an exception.
+   */
+  arr6 = array_new (66 * CINTARRAY_BLOCK + 50, sizeof (uint64_t));
+  arr7 = array_new (array_length (arr6), sizeof (int32_t));
+  for (i = 0, walk = 0; i < array_length (arr6); i++)
+    {
+      seed ^= seed << 13;
+      seed ^= seed >> 7;
+      seed ^= seed << 17;
+      j = i / CINTARRAY_BLOCK;
+      walk += (j == 0 || j > 64 ? 0 : seed >> (64 - j))
+	+ (i % 61 == 0 ? seed : 0);
+      array_put (arr6, i, &walk);
+      value32 = (int32_t) (walk & INT32_MAX);
+      array_put (arr7, i, &value32);
+    }
+  printf ("Compressed blocks of every width: %d mismatches\n",
+	  test_cintarray (arr6) + test_cintarray (arr7));
+  array_delete (&arr6);
+  array_delete (&arr7);
+
+  arr6 = array_new (300, sizeof (int));
+  for (i = 0; i < array_length (arr6); i++)
+    {
+      j = i * 7 % 101;
+      array_put (arr6, i, &j);
+    }
+  array_attachindex (arr6);
+  for (i = 0; i < 50; i++)
+    {
+      j = 100 + i;
+      array_put (arr6, i * 3, &j);
+      array_append (arr6, &i);
+    }
+  free (array_trim (arr6));
+  array_resize (arr6, array_length (arr6) + 10);
+  array_erase (arr6, 5);
+  array_removeif (arr6, test_odd, NULL);
+  for (i = 0; i < array_length (arr6); i += 4)
+    array_put (arr6, i, &i);
+  arr7 = array_copy (arr6);
+  for (i = -1, mismatches = 0; i < 160; i++)
+    {
+      j = array_find (arr6, &i);
+      if ((j < 0) != (array_find (arr7, &i) < 0)
+	  || (j >= 0 && *((int *) array_get (arr6, j)) != i))
+	mismatches++;
+    }
+  printf ("Hash index: %d mismatches\n", mismatches);
+  array_delete (&arr6);
+  array_delete (&arr7);
+
+  for (i = 0; i < 3; i++)
+    {
+      sets[i] = array_new (0, sizeof (int));
+      for (j = 0; j < 3000; j += 3 + 2 * i)
+	array_append (sets[i], &j);
+    }
+  arr6 = array_intersect (sets[0], sets[1], NULL);
+  arr7 = array_union (sets[0], sets[1], test_cmp);
+  arr8 = array_difference (sets[0], sets[1], NULL);
+  printf ("Sets: intersect %d, union %d, difference %d\n",
+	  array_length (arr6), array_length (arr7), array_length (arr8));
+  array_delete (&arr7);
+  array_delete (&arr8);
+  for (i = ARRAY_SCALAR, mismatches = 0; i <= ARRAY_AVX2; i++)
+    {
+      array_setsimd ((Arraysimd) i);
+      arr7 = array_intersect (sets[0], sets[1], NULL);
+      if (!array_equal (arr6, arr7))
+	mismatches++;
+      array_delete (&arr7);
+    }
+  array_setsimd (ARRAY_AVX2);
+  printf ("Intersect at every level: %d mismatches\n", mismatches);
+  array_delete (&arr6);
+  arr6 = array_mergesorted (sets[0], sets[2], test_cmp);
+  arr7 = array_mergek (sets, 3, NULL);
+  arr8 = array_merge (sets[0], sets[1]);
+  printf ("Merges: %d %s, %d %s, %d\n", array_length (arr6),
+	  test_sorted (arr6) ? "sorted" : "unsorted", array_length (arr7),
+	  test_sorted (arr7) ? "sorted" : "unsorted", array_length (arr8));
+  array_delete (&arr6);
+  array_delete (&arr7);
+  array_delete (&arr8);
+  array_resize (sets[1], 0);
+  for (j = 15; j < 3000; j += 1485)
+    array_append (sets[1], &j);
+  arr6 = array_intersect (sets[1], sets[0], NULL);
+  arr7 = array_intersect (sets[0], sets[1], test_cmp);
+  printf ("Skewed intersect: %d %d\n", array_length (arr6),
+	  array_length (arr7));
+  array_delete (&arr6);
+  array_delete (&arr7);
+
+  /*
+   * Array i holds runs of i + 1 elements with the same tens, and its number
+   * as units: a stable merge by tens is sorted.
+   */
+  for (i = 0; i < 3; i++)
+    {
+      array_resize (sets[i], 0);
+      for (j = 0; j < 1000; j++)
+	{
+	  b = j / (i + 1) * 10 + i;
+	  array_append (sets[i], &b);
+	}
+    }
+  arr6 = array_mergek (sets, 3, test_cmptens);
+  arr7 = array_mergek (sets, 3, NULL);
+  printf ("K-way merge of runs: %d %s, %d %s\n", array_length (arr6),
+	  test_sorted (arr6) ? "stable" : "unstable", array_length (arr7),
+	  test_sorted (arr7) ? "sorted" : "unsorted");
+  array_delete (&arr6);
+  array_delete (&arr7);
+  for (i = 0; i < 3; i++)
+    array_delete (&sets[i]);
+
+  kernels[0] = array_new (TEST_KERNEL_ELEMENTS, sizeof (int32_t));
+  kernels[1] = array_new (TEST_KERNEL_ELEMENTS, sizeof (int64_t));
+  kernels[2] = array_new (TEST_KERNEL_ELEMENTS, sizeof (float));
+  kernels[3] = array_new (TEST_KERNEL_ELEMENTS, sizeof (double));
+  for (i = 0; i < TEST_KERNEL_ELEMENTS; i++)
+    {
+      value32 = (int32_t) (i * 7919 % 201 - 100);
+      value64 = value32;
+      valuef = (float) value32;
+      valued = value32;
+      array_put (kernels[0], i, &value32);
+      array_put (kernels[1], i, &value64);
+      array_put (kernels[2], i, &valuef);
+      array_put (kernels[3], i, &valued);
+    }
+  for (i = ARRAY_INT32, j = 0; i <= ARRAY_DOUBLE; i++)
+    {
+      arr6 = array_copy (kernels[i]);
+      array_prefixsum (arr6, (Arraytype) i, true);
+      j += test_kernels ((Arraytype) i, kernels[i], arr6);
+      array_delete (&arr6);
+    }
+  array_minmax (kernels[0], ARRAY_INT32, &argmin, &argmax);
+  printf ("Kernels: %d mismatches, min at %d, max at %d\n", j, argmin,
+	  argmax);
+  /*
+   * Every third element is NaN, starting with the first one, and the
+   * extremes are followed by NaNs in their lanes.
+   */
+  array_resize (kernels[2], 64);
+  array_resize (kernels[3], 64);
+  for (i = 0; i < 64; i++)
+    {
+      valued = i % 3 == 0 ? NAN : i == 4 ? -5 : i == 5 ? 5 : 0;
+      valuef = (float) valued;
+      array_put (kernels[2], i, &valuef);
+      array_put (kernels[3], i, &valued);
+    }
+  for (i = ARRAY_SCALAR, mismatches = 0; i <= ARRAY_AVX2; i++)
+    {
+      array_setsimd ((Arraysimd) i);
+      for (j = ARRAY_FLOAT; j <= ARRAY_DOUBLE; j++)
+	{
+	  array_minmax (kernels[j], (Arraytype) j, &argmin, &argmax);
+	  mismatches += (argmin != 4) + (argmax != 5);
+	}
+    }
+  array_setsimd (ARRAY_AVX2);
+  valued = NAN;
+  array_resize (kernels[3], 5);
+  array_set (kernels[3], &valued);
+  array_minmax (kernels[3], ARRAY_DOUBLE, &argmin, &argmax);
+  printf ("Kernels with NaN: %d mismatches, all NaN at %d and %d\n",
+	  mismatches, argmin, argmax);
+  array_resize (kernels[0], 5);
+  value32 = 1;
+  array_set (kernels[0], &value32);
+  array_prefixsum (kernels[0], ARRAY_INT32, false);
+  for (i = 0; i < array_length (kernels[0]); i++)
+    printf ("%d ", *((int32_t *) array_get (kernels[0], i)));
+  printf ("\n");
+  array_resize (kernels[0], 8);
+  for (value32 = 1; value32 <= 8; value32++)
+    array_put (kernels[0], value32 - 1, &value32);
+  array_attachindex (kernels[0]);
+  array_prefixsum (kernels[0], ARRAY_INT32, true);
+  value32 = 36;
+  i = array_find (kernels[0], &value32);
+  array_axpy (kernels[0], kernels[0], ARRAY_INT32, &value32);
+  value32 = 37 * 36;
+  j = array_find (kernels[0], &value32);
+  array_put (kernels[0], 7, &value32);
+  printf ("Kernels on an indexed array: found at %d and %d\n", i, j);
+  for (i = ARRAY_INT32; i <= ARRAY_DOUBLE; i++)
+    array_delete (&kernels[i]);
+
+  arr6 = array_new (1000, sizeof (int));
+  for (i = 0; i < array_length (arr6); i++)
+    {
+      j = (i * 7919) % 333 - 100;
+      array_put (arr6, i, &j);
+    }
+  arr7 = array_argsort (arr6, test_cmp);
+  arr8 = array_new (0, sizeof (int));
+  array_gather (arr8, arr6, arr7);
+  kernels[0] = array_copy (arr6);
+  array_permuteinplace (kernels[0], arr7);
+  kernels[1] = array_new (array_length (arr6), sizeof (int));
+  array_scatter (kernels[1], arr8, arr7);
+  array_put (arr7, 0, array_get (arr7, 1));
+  printf ("Reorder: %s, permute %s, scatter %s, duplicate index %s\n",
+	  test_sorted (arr8) ? "sorted" : "unsorted",
+	  array_equal (kernels[0], arr8) ? "equal" : "different",
+	  array_equal (kernels[1], arr6) ? "equal" : "different",
+	  array_permuteinplace (kernels[0], arr7) ? "accepted" : "rejected");
+  array_delete (&arr6);
+  array_delete (&arr7);
+  array_delete (&arr8);
+  array_delete (&kernels[0]);
+  array_delete (&kernels[1]);
+
+  test_shared = array_new (1, sizeof (int));
+  array_setconcurrent (test_shared);
+  for (i = 0; i < TEST_READERS; i++)
+    pthread_create (&readers[i], NULL, test_reader, NULL);
+  for (i = 0; i < TEST_RESIZES; i++)
+    {
+      array_resize (test_shared, i % 8 == 0 ? 1000 : 100 + i % 50);
+      for (j = 0; j < array_length (test_shared); j++)
+	array_put (test_shared, j, &j);
+      array_reclaim (test_shared);
+    }
+  __atomic_store_n (&test_stop, true, __ATOMIC_RELAXED);
+  for (i = 0; i < TEST_READERS; i++)
+    pthread_join (readers[i], NULL);
+  array_reclaim (test_shared);
+  array_reclaim (test_shared);
+  printf ("Concurrent read: %d inconsistent reads, %d retired buffers left\n",
+	  test_torn, array_length (test_shared->retired));
+  array_delete (&test_shared);
+
+  test_shared = array_new (0, sizeof (int));
+  array_setconcurrent (test_shared);
+  for (i = 0; i < 20000; i++)
+    array_append (test_shared, &i);
+  for (i = 0, j = 0; i < array_readlength (test_shared); i++)
+    if (array_read (test_shared, i, &b) && b == i)
+      j++;
+  printf ("Concurrent mode appends: %d elements, %d retired buffers\n", j,
+	  array_length (test_shared->retired));
+  arr6 = array_copy (test_shared);
+  array_insertrange (test_shared, 100, ids, TEST_PRODUCERS);
+  array_insertrange (arr6, 100, ids, TEST_PRODUCERS);
+  array_eraserange (test_shared, 0, 15000);
+  array_eraserange (arr6, 0, 15000);
+  array_removeif (test_shared, test_odd, NULL);
+  array_removeif (arr6, test_odd, NULL);
+  array_unique (test_shared, NULL);
+  array_unique (arr6, NULL);
+  printf ("Concurrent mode edits: %d elements, %s\n",
+	  array_readlength (test_shared),
+	  array_equal (test_shared, arr6) ? "equal" : "different");
+  array_delete (&arr6);
+  array_delete (&test_shared);
+
   return 0;
 }
 